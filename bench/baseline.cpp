@@ -0,0 +1,85 @@
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <stack>
+#include "registry.h"
+
+// 비교 기준으로 쓰는 전역 lock 하나짜리 STL container들
+
+namespace
+{
+class MutexSet : public BenchSet
+{
+public:
+	bool add(int key, int) override
+	{
+		std::lock_guard<std::mutex> lg{lock};
+		return set.insert(key).second;
+	}
+	bool remove(int key, int) override
+	{
+		std::lock_guard<std::mutex> lg{lock};
+		return set.erase(key) != 0;
+	}
+	bool contains(int key, int) override
+	{
+		std::lock_guard<std::mutex> lg{lock};
+		return set.count(key) != 0;
+	}
+
+private:
+	std::mutex lock;
+	std::set<int> set;
+};
+
+class MutexQueue : public BenchQueue
+{
+public:
+	void enq(int value, int) override
+	{
+		std::lock_guard<std::mutex> lg{lock};
+		queue.push(value);
+	}
+	std::optional<int> deq(int) override
+	{
+		std::lock_guard<std::mutex> lg{lock};
+		if (queue.empty())
+			return std::nullopt;
+		const auto value = queue.front();
+		queue.pop();
+		return value;
+	}
+
+private:
+	std::mutex lock;
+	std::queue<int> queue;
+};
+
+class MutexStack : public BenchStack
+{
+public:
+	void push(int value, int) override
+	{
+		std::lock_guard<std::mutex> lg{lock};
+		stack.push(value);
+	}
+	std::optional<int> pop(int) override
+	{
+		std::lock_guard<std::mutex> lg{lock};
+		if (stack.empty())
+			return std::nullopt;
+		const auto value = stack.top();
+		stack.pop();
+		return value;
+	}
+
+private:
+	std::mutex lock;
+	std::stack<int> stack;
+};
+
+Registrar<BenchSet> mutex_set{"mutex-std-set", "bench", false, [](int) { return std::make_unique<MutexSet>(); }};
+Registrar<BenchQueue> mutex_queue{"mutex-std-queue", "bench", false, [](int) { return std::make_unique<MutexQueue>(); }};
+Registrar<BenchStack> mutex_stack{"mutex-std-stack", "bench", false, [](int) { return std::make_unique<MutexStack>(); }};
+} // namespace
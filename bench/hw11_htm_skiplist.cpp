@@ -0,0 +1,30 @@
+#include <memory>
+#include "registry.h"
+#include "../숙제11/skiplist.h"
+
+// 숙제11의 HTM skiplist. RTM이 없으면 매번 30번씩 abort 로그를 찍은 뒤에 lock으로 넘어가므로 RTM이 있을 때만 측정한다.
+
+namespace
+{
+class HTMSkiplistSet : public BenchSet
+{
+public:
+	bool add(int key, int) override
+	{
+		return skiplist.insert(key, key);
+	}
+	bool remove(int key, int) override
+	{
+		return skiplist.remove(key);
+	}
+	bool contains(int key, int) override
+	{
+		return skiplist.find(key).has_value();
+	}
+
+private:
+	HTMSkiplist skiplist;
+};
+
+Registrar<BenchSet> htm_skiplist{"htm-skiplist", "숙제11", true, [](int) { return std::make_unique<HTMSkiplistSet>(); }};
+} // namespace
@@ -0,0 +1,63 @@
+#include <memory>
+#include <type_traits>
+#include "registry.h"
+#include "../숙제12/HTM_shared_ptr/list.h"
+
+// 숙제12의 list 기반 set들. 모두 Init/Add/Remove/Contains를 가지고 있어서 adapter 하나로 등록한다.
+
+namespace
+{
+// optimistic/lazy/lock-free list는 Remove한 node를 freelist에 모아두고 recycle_freelist로만 해제함
+template <typename List, typename = void>
+struct has_freelist : std::false_type
+{
+};
+template <typename List>
+struct has_freelist<List, std::void_t<decltype(std::declval<List &>().recycle_freelist())>> : std::true_type
+{
+};
+
+template <typename List>
+class ListSet : public BenchSet
+{
+public:
+	~ListSet()
+	{
+		// 남아있는 node와 Remove된 node 해제. 안 하면 thread/pin sweep의 다음 측정이 커진 heap 위에서 돌게 됨
+		list.Init();
+		if constexpr (has_freelist<List>::value)
+			list.recycle_freelist();
+	}
+
+	bool add(int key, int) override
+	{
+		return list.Add(key);
+	}
+	bool remove(int key, int) override
+	{
+		return list.Remove(key);
+	}
+	bool contains(int key, int) override
+	{
+		return list.Contains(key);
+	}
+
+private:
+	List list;
+};
+
+template <typename List>
+std::unique_ptr<BenchSet> make_list(int)
+{
+	return std::make_unique<ListSet<List>>();
+}
+
+Registrar<BenchSet> coarse{"coarse-list", "숙제12", false, make_list<list_set::CLIST>};
+Registrar<BenchSet> fine{"fine-list", "숙제12", false, make_list<list_set::FLIST>};
+Registrar<BenchSet> optimistic{"optimistic-list", "숙제12", false, make_list<list_set::OLIST>};
+Registrar<BenchSet> lazy{"lazy-list", "숙제12", false, make_list<list_set::ZLIST>};
+// htm_shared_ptr는 transaction이 시작될 때까지 _xbegin을 반복하므로 RTM이 없으면 끝나지 않음
+Registrar<BenchSet> htm_shared_ptr_lazy{"htm-sp-lazy-list", "숙제12", true, make_list<list_set::SPZLIST>};
+Registrar<BenchSet> lock_free{"lock-free-list", "숙제12", false, make_list<list_set::LFLIST>};
+Registrar<BenchSet> coarse_skiplist{"coarse-skiplist", "숙제12", false, make_list<list_set::SKLIST>};
+} // namespace
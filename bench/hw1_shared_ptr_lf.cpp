@@ -0,0 +1,75 @@
+#include <memory>
+#include "registry.h"
+#include "../숙제1/SharedPtrLF/SharedPtrLF/LazySET.h"
+#include "../숙제1/SharedPtrLF/SharedPtrLF/LazySKIPLIST.h"
+#include "../숙제1/SharedPtrLF/SharedPtrLF/lfqueue.h"
+
+// 숙제1에서 shared_ptr로 node를 관리한 구현들.
+// 같은 숙제의 EBR/HP/No_Reclamation 구현은 pointer를 int에 담는 32bit 전용 code라 여기에는 없다.
+
+namespace
+{
+class LazySet : public BenchSet
+{
+public:
+	bool add(int key, int) override
+	{
+		return set.add(key);
+	}
+	bool remove(int key, int) override
+	{
+		return set.remove(key);
+	}
+	bool contains(int key, int) override
+	{
+		return set.contains(key);
+	}
+
+private:
+	shared_ptr_lf::ZSet set;
+};
+
+class LazySkiplistSet : public BenchSet
+{
+public:
+	bool add(int key, int) override
+	{
+		return set.Add(key);
+	}
+	bool remove(int key, int) override
+	{
+		return set.Remove(key);
+	}
+	bool contains(int key, int) override
+	{
+		return set.Contains(key);
+	}
+
+private:
+	shared_ptr_lf::LZSKSET set;
+};
+
+class LockFreeQueue : public BenchQueue
+{
+public:
+	void enq(int value, int) override
+	{
+		queue.Enq(value);
+	}
+	std::optional<int> deq(int) override
+	{
+		// 비어 있으면 -1을 돌려줌. runner는 0 이상의 값만 넣는다.
+		const auto value = queue.Deq();
+		if (value < 0)
+			return std::nullopt;
+		return value;
+	}
+
+private:
+	shared_ptr_lf::LFQUEUE queue;
+};
+
+Registrar<BenchSet> lazy_set{"sp-lazy-list", "숙제1", false, [](int) { return std::make_unique<LazySet>(); }};
+Registrar<BenchSet> lazy_skiplist{"sp-lazy-skiplist", "숙제1", false, [](int) { return std::make_unique<LazySkiplistSet>(); }};
+Registrar<BenchQueue> lock_free_queue{"sp-lf-queue", "숙제1", false, [](int) { return std::make_unique<LockFreeQueue>(); }};
+} // namespace
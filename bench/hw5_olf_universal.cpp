@@ -0,0 +1,44 @@
+#include <memory>
+#include "registry.h"
+#include "../숙제5/skiplist.h"
+#include "../숙제5/olf_universal.h"
+
+// 숙제5의 replica/log 기반 universal construction skiplist.
+// replica 수는 IPP_HW5의 기본값과 같이 1개에서 시작해서 thread 수까지 자동으로 조절한다.
+
+namespace
+{
+using SkiplistUC = OLFUniversal<SkiplistObject, Invoc, Response>;
+
+class UCSkiplistSet : public BenchSet
+{
+public:
+	UCSkiplistSet(int num_thread, WriteMode write_mode) : list{1, num_thread, LogMode::Recycle, write_mode} {}
+
+	bool add(int key, int thread_id) override
+	{
+		return list.apply(Invoc(Func::Add, key), thread_id).value_or(0);
+	}
+	bool remove(int key, int thread_id) override
+	{
+		return list.apply(Invoc(Func::Remove, key), thread_id).value_or(0);
+	}
+	bool contains(int key, int thread_id) override
+	{
+		return list.apply(Invoc(Func::Contains, key), thread_id).value_or(0);
+	}
+
+private:
+	SkiplistUC list;
+};
+
+template <WriteMode MODE>
+std::unique_ptr<BenchSet> make_uc_skiplist(int num_thread)
+{
+	return std::make_unique<UCSkiplistSet>(num_thread, MODE);
+}
+
+Registrar<BenchSet> lock_free{"uc-skiplist-lf", "숙제5", false, make_uc_skiplist<WriteMode::LockFree>};
+Registrar<BenchSet> flat_combining{"uc-skiplist-fc", "숙제5", false, make_uc_skiplist<WriteMode::FlatCombining>};
+Registrar<BenchSet> wait_free{"uc-skiplist-wf", "숙제5", false, make_uc_skiplist<WriteMode::WaitFree>};
+} // namespace
@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <memory>
+#include "registry.h"
+#include "../숙제6/ed_stack.h"
+
+// 숙제6의 Elimination + Delegation stack. 측정할 pin 정책을 모르므로 thread 수가 허락하는 만큼 모든 node에 array를 둔다.
+
+namespace
+{
+class EDStackAdapter : public BenchStack
+{
+public:
+	explicit EDStackAdapter(unsigned num_thread)
+		: stack{EDStack<int>::slots_per_node(num_thread), std::min<unsigned>(num_thread, CpuTopology::get().num_nodes())}
+	{
+	}
+
+	void push(int value, int) override
+	{
+		stack.push(value);
+	}
+	std::optional<int> pop(int) override
+	{
+		return stack.pop();
+	}
+
+private:
+	EDStack<int> stack;
+};
+
+Registrar<BenchStack> ed_stack{"ed-stack", "숙제6", false, [](int num_thread) { return std::make_unique<EDStackAdapter>(num_thread); }};
+} // namespace
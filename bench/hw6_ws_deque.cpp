@@ -0,0 +1,28 @@
+#include <memory>
+#include "registry.h"
+#include "../숙제6/ws_deque.h"
+
+// 숙제6의 work-stealing deque를 thread마다 하나씩 둔 stack. ed-stack과 같은 workload로 비교하기 위해 등록
+
+namespace
+{
+class WorkStealingAdapter : public BenchStack
+{
+public:
+	explicit WorkStealingAdapter(unsigned num_thread) : stack{num_thread} {}
+
+	void push(int value, int thread_id) override
+	{
+		stack.push(value, thread_id);
+	}
+	std::optional<int> pop(int thread_id) override
+	{
+		return stack.pop(thread_id);
+	}
+
+private:
+	WorkStealingStack<int> stack;
+};
+
+Registrar<BenchStack> ws_deque{"ws-deque", "숙제6", false, [](int num_thread) { return std::make_unique<WorkStealingAdapter>(num_thread); }};
+} // namespace
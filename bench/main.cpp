@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "registry.h"
+#include "options.h"
+#include "key_space.h"
+#include "latency_histogram.h"
+#include "history.h"
+#include "topology.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// 자료구조 종류마다 연산을 고르고 수행하는 방법. 모든 구현이 같은 난수 순서로 같은 연산을 받는다.
+// history는 --check일 때만 넘어오며 CHECKABLE인 종류만 기록한다.
+template <typename Interface>
+struct BenchKind;
+
+template <>
+struct BenchKind<BenchSet>
+{
+	static constexpr const char *NAME = "set";
+	static constexpr size_t NUM_OPS = 3;
+	static constexpr const char *OP_NAMES[NUM_OPS] = {"Add     ", "Remove  ", "Contains"};
+	static constexpr bool CHECKABLE = true;
+
+	static size_t run_op(BenchSet &set, KeyGenerator &gen, const BenchOptions &options, int thread_id, int, HistoryRecorder *history)
+	{
+		const auto ticket = static_cast<int>(gen.next_rand() % 100);
+		const auto key = gen.next_key();
+		if (ticket < options.read)
+		{
+			recorded(history, thread_id, HistoryOp::Contains, key, [&] { return set.contains(key, thread_id); });
+			return 2;
+		}
+		if (ticket < options.read + options.add)
+		{
+			recorded(history, thread_id, HistoryOp::Add, key, [&] { return set.add(key, thread_id); });
+			return 0;
+		}
+		recorded(history, thread_id, HistoryOp::Remove, key, [&] { return set.remove(key, thread_id); });
+		return 1;
+	}
+
+	// 분포가 치우쳐 있어도 금방 채워지도록 uniform으로 서로 다른 key를 고름
+	static void prefill(BenchSet &set, const BenchOptions &options, HistoryRecorder *history)
+	{
+		KeySpace uniform = options;
+		uniform.dist = KeyDist::Uniform;
+		KeyGenerator gen{uniform, MAX_BENCH_THREAD};
+		for (auto inserted = 0; inserted < options.prefill;)
+		{
+			const auto key = gen.next_key();
+			if (set.add(key, 0))
+			{
+				++inserted;
+				if (history != nullptr)
+					history->add_initial(key);
+			}
+		}
+	}
+
+private:
+	template <typename Op>
+	static bool recorded(HistoryRecorder *history, int thread_id, HistoryOp op, int key, Op &&run)
+	{
+		if (history == nullptr)
+			return run();
+		const auto invoke = LatencyClock::now();
+		const auto result = run();
+		history->record(thread_id, op, key, result, invoke, LatencyClock::now());
+		return result;
+	}
+};
+
+template <>
+struct BenchKind<BenchQueue>
+{
+	static constexpr const char *NAME = "queue";
+	static constexpr size_t NUM_OPS = 2;
+	static constexpr const char *OP_NAMES[NUM_OPS] = {"Enq     ", "Deq     "};
+	static constexpr bool CHECKABLE = false;
+
+	static size_t run_op(BenchQueue &queue, KeyGenerator &gen, const BenchOptions &options, int thread_id, int value, HistoryRecorder *)
+	{
+		if (static_cast<int>(gen.next_rand() % 100) < options.push)
+		{
+			queue.enq(value, thread_id);
+			return 0;
+		}
+		queue.deq(thread_id);
+		return 1;
+	}
+
+	static void prefill(BenchQueue &queue, const BenchOptions &options, HistoryRecorder *)
+	{
+		for (auto i = 0; i < options.prefill; ++i)
+			queue.enq(i, 0);
+	}
+};
+
+template <>
+struct BenchKind<BenchStack>
+{
+	static constexpr const char *NAME = "stack";
+	static constexpr size_t NUM_OPS = 2;
+	static constexpr const char *OP_NAMES[NUM_OPS] = {"Push    ", "Pop     "};
+	static constexpr bool CHECKABLE = false;
+
+	static size_t run_op(BenchStack &stack, KeyGenerator &gen, const BenchOptions &options, int thread_id, int value, HistoryRecorder *)
+	{
+		if (static_cast<int>(gen.next_rand() % 100) < options.push)
+		{
+			stack.push(value, thread_id);
+			return 0;
+		}
+		stack.pop(thread_id);
+		return 1;
+	}
+
+	static void prefill(BenchStack &stack, const BenchOptions &options, HistoryRecorder *)
+	{
+		for (auto i = 0; i < options.prefill; ++i)
+			stack.push(i, 0);
+	}
+};
+
+template <size_t NUM_OPS>
+struct alignas(64) ThreadResult
+{
+	long long num_ops = 0;
+	OpLatency<NUM_OPS> latency;
+	ThreadPlacement placement;
+};
+
+template <size_t NUM_OPS>
+struct RunResult
+{
+	milliseconds duration;
+	long long num_ops;
+	OpLatency<NUM_OPS> latency;
+	vector<ThreadPlacement> placements;
+	// --check로 검사했을 때만 있음
+	optional<LinearizabilityReport> check;
+};
+
+// 모든 thread가 만들어지고 CPU에 고정된 뒤에 start가 켜지면 동시에 시작한다.
+template <typename Interface>
+void ThreadFunc(Interface *target, const BenchOptions *options, int num_thread, int thread_id, const vector<int> *cpus, HistoryRecorder *history,
+				atomic_int *ready, const atomic_bool *start, const atomic_bool *stop, ThreadResult<BenchKind<Interface>::NUM_OPS> *result)
+{
+	pin_thread(*cpus, thread_id);
+	KeyGenerator gen{*options, thread_id};
+	const auto num_ops = options->duration_ms > 0 ? LLONG_MAX : options->num_ops / num_thread;
+
+	ready->fetch_add(1, memory_order_release);
+	while (!start->load(memory_order_acquire))
+		this_thread::yield();
+
+	for (long long i = 0; i < num_ops; ++i)
+	{
+		// history buffer가 차면 더 기록할 수 없으므로 이 thread는 멈춤
+		if (stop->load(memory_order_relaxed) || (history != nullptr && history->full(thread_id)))
+			break;
+		const auto op_begin = LatencyClock::now();
+		const auto op = BenchKind<Interface>::run_op(*target, gen, *options, thread_id, static_cast<int>(i & INT_MAX), history);
+		result->latency.record(op, op_begin);
+		++result->num_ops;
+	}
+	result->placement = ThreadPlacement::current();
+}
+
+template <typename Interface>
+RunResult<BenchKind<Interface>::NUM_OPS> run_bench(const BenchEntry<Interface> &entry, const BenchOptions &options, int num_thread, const vector<int> &cpus)
+{
+	constexpr auto NUM_OPS = BenchKind<Interface>::NUM_OPS;
+	auto target = entry.make(num_thread);
+	// 정해진 연산 수로 돌 때는 thread마다 정확히 그만큼, 시간으로 돌 때는 --history만큼 기록할 자리를 둠
+	unique_ptr<HistoryRecorder> history;
+	if (options.check && BenchKind<Interface>::CHECKABLE)
+	{
+		const auto capacity = options.duration_ms > 0 ? options.history_capacity : static_cast<size_t>(options.num_ops / num_thread);
+		history = make_unique<HistoryRecorder>(num_thread, capacity);
+	}
+	BenchKind<Interface>::prefill(*target, options, history.get());
+
+	vector<ThreadResult<NUM_OPS>> results(num_thread);
+	atomic_int ready{0};
+	atomic_bool start{false};
+	atomic_bool stop{false};
+	vector<thread> threads;
+	for (int i = 0; i < num_thread; ++i)
+		threads.emplace_back(ThreadFunc<Interface>, target.get(), &options, num_thread, i, &cpus, history.get(), &ready, &start, &stop, &results[i]);
+	while (ready.load(memory_order_acquire) < num_thread)
+		this_thread::yield();
+
+	auto s = high_resolution_clock::now();
+	start.store(true, memory_order_release);
+	if (options.duration_ms > 0)
+	{
+		this_thread::sleep_for(milliseconds(options.duration_ms));
+		stop.store(true, memory_order_relaxed);
+	}
+	for (auto &th : threads)
+		th.join();
+	auto d = high_resolution_clock::now() - s;
+
+	RunResult<NUM_OPS> result{duration_cast<milliseconds>(d), 0, {}, {}, {}};
+	for (auto &r : results)
+	{
+		result.num_ops += r.num_ops;
+		result.latency.merge(r.latency);
+		result.placements.push_back(r.placement);
+	}
+	if (history)
+		result.check = check_set_linearizability(*history);
+	return result;
+}
+
+template <size_t NUM_OPS>
+double throughput(const RunResult<NUM_OPS> &result)
+{
+	return result.duration.count() == 0 ? 0.0 : result.num_ops * 1000.0 / result.duration.count();
+}
+
+void print_header(const BenchOptions &options)
+{
+	switch (options.format)
+	{
+	case OutputFormat::Text:
+		CpuTopology::get().describe(cout);
+		cout << "Keys : " << options.key_range << " (" << to_string(options.dist) << "),  Set Mix : " << options.read << ':' << options.add << ':'
+			 << options.remove << ",  Push : " << options.push << "%,  Prefill : " << options.prefill << endl;
+		break;
+	case OutputFormat::Csv:
+		cout << "kind,impl,origin,pin,threads,read,add,remove,push,keys,dist,prefill,ops,duration_ms,ops_per_sec,placement,linearizable,op,count,p50_ns,p99_ns,p999_ns,max_ns" << endl;
+		break;
+	}
+}
+
+void print_csv_line(const string &prefix, const char *op, const LatencyHistogram &h)
+{
+	cout << prefix << ',' << op << ',' << h.count() << ',' << h.percentile(0.5) << ',' << h.percentile(0.99) << ',' << h.percentile(0.999) << ','
+		 << h.max() << endl;
+}
+
+template <typename Interface>
+void print_result(const BenchEntry<Interface> &entry, const BenchOptions &options, PinPolicy pin, int num_thread,
+				  const RunResult<BenchKind<Interface>::NUM_OPS> &result)
+{
+	using Kind = BenchKind<Interface>;
+	const auto total = result.latency.total();
+	switch (options.format)
+	{
+	case OutputFormat::Text:
+		cout << num_thread << "Threads,  Pin : " << to_string(pin);
+		cout << ",  Duration : " << result.duration.count() << " msecs";
+		cout << ",  Throughput : " << static_cast<long long>(throughput(result)) << " ops/s";
+		cout << ",  p50 : " << total.percentile(0.5) << " ns";
+		cout << ",  p99 : " << total.percentile(0.99) << " ns";
+		cout << ",  max : " << total.max() << " ns." << endl;
+		for (size_t op = 0; op < Kind::NUM_OPS; ++op)
+			print_latency_line(cout, Kind::OP_NAMES[op], result.latency[op]);
+		print_placement(cout, result.placements.begin(), result.placements.end());
+		if (result.check)
+			result.check->print(cout);
+		break;
+	case OutputFormat::Csv:
+	{
+		// 연산 종류마다 한 줄, 그리고 전체를 합친 줄 (op = all)
+		const auto placement = placement_string(result.placements.begin(), result.placements.end());
+		const auto prefix = string{Kind::NAME} + ',' + entry.name + ',' + entry.origin + ',' + to_string(pin) + ',' + std::to_string(num_thread) + ',' +
+							std::to_string(options.read) + ',' + std::to_string(options.add) + ',' + std::to_string(options.remove) + ',' +
+							std::to_string(options.push) + ',' + std::to_string(options.key_range) + ',' + to_string(options.dist) + ',' +
+							std::to_string(options.prefill) + ',' + std::to_string(result.num_ops) + ',' + std::to_string(result.duration.count()) + ',' +
+							std::to_string(static_cast<long long>(throughput(result))) + ',' + placement + ',' +
+							(result.check ? result.check->verdict() : "-");
+		for (size_t op = 0; op < Kind::NUM_OPS; ++op)
+		{
+			string name = Kind::OP_NAMES[op];
+			name.erase(name.find_last_not_of(' ') + 1);
+			print_csv_line(prefix, name.c_str(), result.latency[op]);
+		}
+		print_csv_line(prefix, "all", total);
+		break;
+	}
+	}
+}
+
+bool has_rtm()
+{
+	return __builtin_cpu_supports("rtm");
+}
+
+template <typename Interface>
+void list_entries()
+{
+	for (auto &entry : Registry<Interface>::entries())
+	{
+		cout << BenchKind<Interface>::NAME << '\t' << entry.name << '\t' << entry.origin;
+		if (entry.needs_rtm)
+			cout << "\t(needs RTM)";
+		cout << endl;
+	}
+}
+
+template <typename Interface>
+bool is_registered(const string &name)
+{
+	const auto &entries = Registry<Interface>::entries();
+	return any_of(entries.begin(), entries.end(), [&name](const BenchEntry<Interface> &entry) { return entry.name == name; });
+}
+
+template <typename Interface>
+void run_kind(const BenchOptions &options)
+{
+	const auto &kinds = options.kinds;
+	if (find(kinds.begin(), kinds.end(), BenchKind<Interface>::NAME) == kinds.end())
+		return;
+
+	for (auto &entry : Registry<Interface>::entries())
+	{
+		if (!options.impls.empty() && find(options.impls.begin(), options.impls.end(), entry.name) == options.impls.end())
+			continue;
+		if (entry.needs_rtm && !options.force_htm && !has_rtm())
+		{
+			fprintf(stderr, "skip %s: this CPU has no RTM (use --force-htm to run anyway)\n", entry.name.c_str());
+			continue;
+		}
+
+		if (options.format == OutputFormat::Text)
+			cout << "[" << BenchKind<Interface>::NAME << "] " << entry.name << " (" << entry.origin << ")" << endl;
+		for (auto pin : options.pins)
+		{
+			const auto cpus = CpuTopology::get().order(pin);
+			for (auto n : options.threads)
+				print_result(entry, options, pin, n, run_bench(entry, options, n, cpus));
+		}
+	}
+}
+
+// 등록된 모든 set/queue/stack 구현을 같은 workload, thread 수, pinning 조건으로 측정한다. 인자는 options.h의 print_usage 참고.
+int main(int argc, char *argv[])
+{
+	const auto options = parse_options(argc, argv);
+
+	if (options.list)
+	{
+		list_entries<BenchSet>();
+		list_entries<BenchQueue>();
+		list_entries<BenchStack>();
+		return 0;
+	}
+
+	for (auto &name : options.impls)
+	{
+		if (!is_registered<BenchSet>(name) && !is_registered<BenchQueue>(name) && !is_registered<BenchStack>(name))
+		{
+			fprintf(stderr, "unknown implementation: %s (see --list)\n", name.c_str());
+			return -1;
+		}
+	}
+
+	print_header(options);
+	run_kind<BenchSet>(options);
+	run_kind<BenchQueue>(options);
+	run_kind<BenchStack>(options);
+}
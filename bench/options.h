@@ -0,0 +1,219 @@
+#ifndef B1D64F93_3A2E_4C7B_8E05_F6A92C1D40B7
+#define B1D64F93_3A2E_4C7B_8E05_F6A92C1D40B7
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "key_space.h"
+#include "topology.h"
+
+// IPP_Bench의 측정 조건. 모든 자료구조가 같은 조건으로 측정되도록 한 곳에서 정한다.
+
+constexpr int MAX_BENCH_THREAD = 64;
+
+enum class OutputFormat
+{
+	Text,
+	Csv,
+};
+
+// key 범위와 분포는 KeySpace에서 물려받음
+struct BenchOptions : KeySpace
+{
+	// 측정할 종류 (set, queue, stack)
+	std::vector<std::string> kinds{"set", "queue", "stack"};
+	// 비어 있으면 해당 종류의 모든 구현
+	std::vector<std::string> impls;
+	// set 연산 비율 (%). 합은 100
+	int read = 30;
+	int add = 35;
+	int remove = 35;
+	// queue/stack에서 넣는 연산(enq/push)의 비율 (%)
+	int push = 50;
+	// set은 서로 다른 key를, queue/stack은 값을 이만큼 미리 넣어둠
+	int prefill = 0;
+	// 전체 연산 수를 thread들이 나눠서 수행. duration_ms가 0보다 크면 무시하고 시간만큼 수행
+	long long num_ops = 1000000;
+	int duration_ms = 0;
+	std::vector<int> threads;
+	std::vector<PinPolicy> pins{PinPolicy::Compact};
+	OutputFormat format = OutputFormat::Text;
+	// 등록된 구현만 출력하고 끝냄
+	bool list = false;
+	// RTM이 없어도 HTM 구현을 측정
+	bool force_htm = false;
+	// set의 연산 기록을 남기고 측정이 끝날 때마다 linearizability를 검사
+	bool check = false;
+	// --duration과 같이 쓸 때 thread마다 기록할 수 있는 연산 수
+	size_t history_capacity = 1 << 18;
+};
+
+inline void print_usage(const char *prog)
+{
+	fprintf(stderr,
+			"usage: %s [options]\n"
+			"  --list                   print registered implementations and exit\n"
+			"  --kind=set,queue,stack   kinds to measure (default all)\n"
+			"  --impl=NAME,...          implementations to measure (default all of each kind)\n"
+			"  --read=P                 set: P%% contains, the rest split between add/remove\n"
+			"  --mix=R:A:D              set: contains:add:remove percentages\n"
+			"  --push=P                 queue/stack: P%% enq/push, the rest deq/pop (default 50)\n"
+			"  --keys=N                 key range (default 1000)\n"
+			"  --dist=uniform|zipf|hotspot\n"
+			"  --zipf=THETA             zipf skew (default 0.99)\n"
+			"  --hot=K:O                hotspot: K%% of keys get O%% of operations (default 20:80)\n"
+			"  --prefill=N              insert N keys (set) or values (queue/stack) before measuring\n"
+			"  --ops=N                  total operations per run (default 1000000)\n"
+			"  --duration=MS            run for MS milliseconds instead of a fixed op count\n"
+			"  --threads=1,2,4          thread counts (default 1,2,4,... up to the number of CPUs)\n"
+			"  --pin=none,compact,scatter,smt  thread placement policies to sweep (default compact)\n"
+			"  --force-htm              run HTM implementations even without RTM support\n"
+			"  --check                  record set histories and check linearizability after each run\n"
+			"  --history=N              with --duration, per-thread history capacity (default 262144)\n"
+			"  --format=text|csv\n",
+			prog);
+}
+
+// 잘못된 인자가 있으면 사용법을 출력하고 종료한다.
+inline BenchOptions parse_options(int argc, char *argv[])
+{
+	BenchOptions options;
+	auto fail = [argv](const std::string &arg) {
+		fprintf(stderr, "invalid argument: %s\n", arg.c_str());
+		print_usage(argv[0]);
+		exit(-1);
+	};
+
+	for (auto i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help")
+		{
+			print_usage(argv[0]);
+			exit(0);
+		}
+		if (arg == "--list")
+		{
+			options.list = true;
+			continue;
+		}
+		if (arg == "--force-htm")
+		{
+			options.force_htm = true;
+			continue;
+		}
+		if (arg == "--check")
+		{
+			options.check = true;
+			continue;
+		}
+
+		const auto eq = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+			fail(arg);
+		const auto name = arg.substr(2, eq - 2);
+		const auto value = arg.substr(eq + 1);
+		bool ok;
+
+		if (name == "kind")
+		{
+			options.kinds = split(value, ',');
+			for (auto &kind : options.kinds)
+			{
+				if (kind != "set" && kind != "queue" && kind != "stack")
+					fail(arg);
+			}
+		}
+		else if (name == "impl")
+			options.impls = split(value, ',');
+		else if (name == "read")
+		{
+			options.read = std::atoi(value.c_str());
+			options.add = (100 - options.read) / 2;
+			options.remove = 100 - options.read - options.add;
+		}
+		else if (name == "mix")
+		{
+			const auto tokens = split(value, ':');
+			if (tokens.size() != 3)
+				fail(arg);
+			options.read = std::atoi(tokens[0].c_str());
+			options.add = std::atoi(tokens[1].c_str());
+			options.remove = std::atoi(tokens[2].c_str());
+		}
+		else if (name == "push")
+			options.push = std::atoi(value.c_str());
+		else if (parse_key_option(name, value, options, ok))
+		{
+			if (!ok)
+				fail(arg);
+		}
+		else if (name == "prefill")
+			options.prefill = std::atoi(value.c_str());
+		else if (name == "ops")
+			options.num_ops = std::atoll(value.c_str());
+		else if (name == "duration")
+			options.duration_ms = std::atoi(value.c_str());
+		else if (name == "history")
+			options.history_capacity = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "threads")
+		{
+			for (auto &token : split(value, ','))
+				options.threads.push_back(std::atoi(token.c_str()));
+		}
+		else if (name == "pin")
+		{
+			options.pins.clear();
+			for (auto &token : split(value, ','))
+			{
+				PinPolicy policy;
+				if (!parse_pin_policy(token, policy))
+					fail(arg);
+				options.pins.push_back(policy);
+			}
+		}
+		else if (name == "format")
+		{
+			if (value == "text")
+				options.format = OutputFormat::Text;
+			else if (value == "csv")
+				options.format = OutputFormat::Csv;
+			else
+				fail(arg);
+		}
+		else
+			fail(arg);
+	}
+
+	if (options.threads.empty())
+	{
+		const auto num_cpu = std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), MAX_BENCH_THREAD));
+		for (auto n = 1; n < num_cpu; n *= 2)
+			options.threads.push_back(n);
+		options.threads.push_back(num_cpu);
+	}
+	for (auto n : options.threads)
+	{
+		if (n < 1 || MAX_BENCH_THREAD < n)
+			fail("--threads");
+	}
+	if (options.read < 0 || options.add < 0 || options.remove < 0 || options.read + options.add + options.remove != 100)
+		fail("--mix");
+	if (options.push < 0 || 100 < options.push)
+		fail("--push");
+	if (options.prefill < 0 || options.num_ops < 1)
+		fail("--prefill/--ops");
+	if (options.history_capacity < 1)
+		fail("--history");
+	// set은 서로 다른 key로 채우므로 key 범위보다 많이 넣을 수 없음
+	if (options.key_range < options.prefill && std::find(options.kinds.begin(), options.kinds.end(), "set") != options.kinds.end())
+		fail("--keys/--prefill");
+	if (!options.prepare())
+		fail("--keys/--dist/--zipf/--hot");
+	return options;
+}
+
+#endif /* B1D64F93_3A2E_4C7B_8E05_F6A92C1D40B7 */
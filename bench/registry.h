@@ -0,0 +1,74 @@
+#ifndef A4C7E1B9_62D0_4F58_93AE_0B5D8C21F7E6
+#define A4C7E1B9_62D0_4F58_93AE_0B5D8C21F7E6
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// 각 과제의 자료구조를 같은 interface 뒤에 등록해서 하나의 runner로 같은 조건에서 측정한다.
+// 자료구조마다 adapter를 만들고 adapter가 있는 .cpp에서 Registrar 전역 객체로 등록하면 main은 따로 고칠 필요가 없다.
+// thread_id는 0부터 (thread 수 - 1)까지이며 thread 번호가 필요한 자료구조만 사용한다.
+
+class BenchSet
+{
+public:
+	virtual ~BenchSet() = default;
+	virtual bool add(int key, int thread_id) = 0;
+	virtual bool remove(int key, int thread_id) = 0;
+	virtual bool contains(int key, int thread_id) = 0;
+};
+
+class BenchQueue
+{
+public:
+	virtual ~BenchQueue() = default;
+	virtual void enq(int value, int thread_id) = 0;
+	// 비어 있으면 nullopt
+	virtual std::optional<int> deq(int thread_id) = 0;
+};
+
+class BenchStack
+{
+public:
+	virtual ~BenchStack() = default;
+	virtual void push(int value, int thread_id) = 0;
+	// 비어 있으면 nullopt
+	virtual std::optional<int> pop(int thread_id) = 0;
+};
+
+template <typename Interface>
+struct BenchEntry
+{
+	std::string name;
+	// 원래 구현이 있는 과제 폴더
+	std::string origin;
+	// RTM(HTM) 없이는 진행하지 못하거나 abort 로그만 쏟아내는 구현
+	bool needs_rtm;
+	// 인자는 이번 측정의 thread 수. thread 수에 맞춰 내부 크기를 정하는 구현이 있어서 측정마다 새로 만든다.
+	std::function<std::unique_ptr<Interface>(int num_thread)> make;
+};
+
+template <typename Interface>
+class Registry
+{
+public:
+	static std::vector<BenchEntry<Interface>> &entries()
+	{
+		// 다른 .cpp의 전역 Registrar가 먼저 초기화될 수 있으므로 함수 안의 static으로 둠
+		static std::vector<BenchEntry<Interface>> list;
+		return list;
+	}
+};
+
+template <typename Interface>
+struct Registrar
+{
+	Registrar(const char *name, const char *origin, bool needs_rtm, std::function<std::unique_ptr<Interface>(int)> make)
+	{
+		Registry<Interface>::entries().push_back(BenchEntry<Interface>{name, origin, needs_rtm, std::move(make)});
+	}
+};
+
+#endif /* A4C7E1B9_62D0_4F58_93AE_0B5D8C21F7E6 */
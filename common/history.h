@@ -0,0 +1,386 @@
+#ifndef A9E34C71_5B28_4D6F_8C13_E0B7F52A94D6
+#define A9E34C71_5B28_4D6F_8C13_E0B7F52A94D6
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "latency_histogram.h"
+
+// 동시 set의 연산 기록과 linearizability 검사.
+// 측정 중에는 thread마다 미리 할당해둔 buffer에 (호출 시각, 응답 시각, 연산, key, 결과)만 적고,
+// 끝난 뒤에 key마다 따로 Wing-Gong 탐색으로 검사한다. set은 key끼리 서로 영향을 주지 않으므로
+// key별 history가 모두 linearizable이면 전체도 linearizable (P-compositionality).
+
+enum class HistoryOp : uint8_t
+{
+	Add,
+	Remove,
+	Contains,
+};
+
+struct HistoryEvent
+{
+	// recorder를 만든 시점부터의 ns
+	uint64_t invoke_ns;
+	uint64_t response_ns;
+	int key;
+	HistoryOp op;
+	bool result;
+};
+
+class HistoryRecorder
+{
+public:
+	// 측정 중에 할당이나 page fault가 생기지 않도록 buffer를 모두 0으로 채워둔다.
+	HistoryRecorder(int num_thread, size_t capacity_per_thread) : base{LatencyClock::now()}, buffers(num_thread)
+	{
+		for (auto &buffer : buffers)
+		{
+			buffer.events.reset(new HistoryEvent[capacity_per_thread]());
+			buffer.capacity = capacity_per_thread;
+		}
+	}
+
+	// invoke는 연산을 시작하기 전, response는 연산이 돌아온 뒤에 잰 시각. 가득 찼으면 기록하지 않고 false
+	bool record(int thread_id, HistoryOp op, int key, bool result, LatencyClock::time_point invoke, LatencyClock::time_point response)
+	{
+		auto &buffer = buffers[thread_id];
+		if (buffer.size == buffer.capacity)
+		{
+			buffer.truncated = true;
+			return false;
+		}
+		buffer.events[buffer.size++] = HistoryEvent{since_base(invoke), since_base(response), key, op, result};
+		return true;
+	}
+
+	bool full(int thread_id) const
+	{
+		return buffers[thread_id].size == buffers[thread_id].capacity;
+	}
+
+	// 측정 전에 순차적으로 넣어둔 key. 검사할 때 처음부터 들어있는 것으로 봄
+	void add_initial(int key)
+	{
+		initial.push_back(key);
+	}
+
+	const std::vector<int> &initial_keys() const
+	{
+		return initial;
+	}
+
+	// 버리고 기록하지 못한 연산이 있으면 history가 불완전하므로 검사할 수 없음
+	bool truncated() const
+	{
+		return std::any_of(buffers.begin(), buffers.end(), [](const Buffer &buffer) { return buffer.truncated; });
+	}
+
+	// 모든 thread의 기록을 합친다. 측정 thread가 모두 끝난 뒤에만 호출.
+	std::vector<HistoryEvent> events() const
+	{
+		std::vector<HistoryEvent> all;
+		for (auto &buffer : buffers)
+			all.insert(all.end(), buffer.events.get(), buffer.events.get() + buffer.size);
+		return all;
+	}
+
+private:
+	struct alignas(64) Buffer
+	{
+		std::unique_ptr<HistoryEvent[]> events;
+		size_t size = 0;
+		size_t capacity = 0;
+		bool truncated = false;
+	};
+
+	uint64_t since_base(LatencyClock::time_point t) const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(t - base).count();
+	}
+
+	const LatencyClock::time_point base;
+	std::vector<Buffer> buffers;
+	std::vector<int> initial;
+};
+
+struct LinearizabilityReport
+{
+	bool truncated = false;
+	size_t num_ops = 0;
+	size_t num_keys = 0;
+	// linearization이 없는 key
+	std::vector<int> bad_keys;
+	// 탐색 한도를 넘어서 판단하지 못한 key
+	std::vector<int> undecided_keys;
+
+	bool ok() const
+	{
+		return !truncated && bad_keys.empty() && undecided_keys.empty();
+	}
+
+	const char *verdict() const
+	{
+		if (truncated)
+			return "truncated";
+		if (!bad_keys.empty())
+			return "no";
+		if (!undecided_keys.empty())
+			return "unknown";
+		return "yes";
+	}
+
+	void print(std::ostream &os) const
+	{
+		os << "    Linearizable : " << verdict() << " (" << num_ops << " ops on " << num_keys << " keys";
+		const auto print_keys = [&os](const char *label, const std::vector<int> &keys) {
+			if (keys.empty())
+				return;
+			os << ", " << label << " :";
+			for (size_t i = 0; i < keys.size() && i < 10; ++i)
+				os << ' ' << keys[i];
+			if (keys.size() > 10)
+				os << " ...";
+		};
+		print_keys("violating keys", bad_keys);
+		print_keys("undecided keys", undecided_keys);
+		os << ")" << std::endl;
+	}
+};
+
+namespace history_detail
+{
+// key 하나의 상태(들어있는지)에 연산을 적용. 결과가 상태와 맞지 않으면 false
+inline bool step(bool present, const HistoryEvent &e, bool &next)
+{
+	switch (e.op)
+	{
+	case HistoryOp::Add:
+		next = true;
+		return e.result == !present;
+	case HistoryOp::Remove:
+		next = false;
+		return e.result == present;
+	case HistoryOp::Contains:
+		next = present;
+		return e.result == present;
+	}
+	return false;
+}
+
+struct BitsHash
+{
+	size_t operator()(const std::vector<uint64_t> &bits) const
+	{
+		uint64_t h = 0xCBF29CE484222325ull;
+		for (auto word : bits)
+			h = (h ^ word) * 0x100000001B3ull;
+		return static_cast<size_t>(h);
+	}
+};
+
+enum class SearchResult
+{
+	Found,
+	NotFound,
+	Exhausted,
+};
+
+// Wing & Gong의 탐색에 Lowe의 memoization을 더한 방법.
+// ops를 start 상태에서 시작해 실시간 순서를 지키며 모두 linearize해서 target 상태로 끝낼 수 있는지 찾는다.
+inline SearchResult search(const std::vector<HistoryEvent> &ops, bool start, bool target, size_t &steps, size_t max_steps)
+{
+	const auto n = static_cast<int>(ops.size());
+	// 0..2n-1은 호출/응답 entry, 2n은 list의 head
+	struct Entry
+	{
+		int op;
+		bool is_call;
+		uint64_t time;
+	};
+	std::vector<Entry> entries;
+	entries.reserve(2 * n);
+	for (auto i = 0; i < n; ++i)
+	{
+		entries.push_back(Entry{i, true, ops[i].invoke_ns});
+		entries.push_back(Entry{i, false, ops[i].response_ns});
+	}
+	// 시각이 같으면 호출을 먼저 둬서 겹치는 것으로 봄
+	std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+		return a.time != b.time ? a.time < b.time : a.is_call > b.is_call;
+	});
+
+	const auto head = 2 * n;
+	std::vector<int> prev(2 * n + 1), next(2 * n + 1), match(2 * n);
+	std::vector<int> call_of(n);
+	for (auto i = 0; i < 2 * n; ++i)
+	{
+		prev[i] = i == 0 ? head : i - 1;
+		next[i] = i + 1 == 2 * n ? -1 : i + 1;
+		if (entries[i].is_call)
+			call_of[entries[i].op] = i;
+	}
+	next[head] = n == 0 ? -1 : 0;
+	for (auto i = 0; i < 2 * n; ++i)
+	{
+		if (!entries[i].is_call)
+		{
+			match[i] = call_of[entries[i].op];
+			match[call_of[entries[i].op]] = i;
+		}
+	}
+	const auto unlink = [&](int e) {
+		next[prev[e]] = next[e];
+		if (next[e] >= 0)
+			prev[next[e]] = prev[e];
+	};
+	const auto relink = [&](int e) {
+		next[prev[e]] = e;
+		if (next[e] >= 0)
+			prev[next[e]] = e;
+	};
+
+	// 마지막 word의 최상위 bit에 상태를 같이 넣어서 cache의 key로 씀
+	std::vector<uint64_t> bits(n / 64 + 1, 0);
+	const auto state_bit = uint64_t{1} << 63;
+	std::unordered_set<std::vector<uint64_t>, BitsHash> cache;
+	std::vector<std::pair<int, bool>> calls;
+	auto state = start;
+	auto e = next[head];
+
+	const auto backtrack = [&]() {
+		if (calls.empty())
+			return false;
+		const auto call = calls.back();
+		calls.pop_back();
+		const auto op = entries[call.first].op;
+		bits[op / 64] &= ~(uint64_t{1} << (op % 64));
+		state = call.second;
+		relink(match[call.first]);
+		relink(call.first);
+		e = next[call.first];
+		return true;
+	};
+
+	while (true)
+	{
+		if (++steps > max_steps)
+			return SearchResult::Exhausted;
+		if (next[head] < 0)
+		{
+			if (state == target)
+				return SearchResult::Found;
+			if (!backtrack())
+				return SearchResult::NotFound;
+			continue;
+		}
+		if (e < 0 || !entries[e].is_call)
+		{
+			// 아직 linearize하지 않은 연산의 응답에 닿으면 그 앞의 선택을 바꿔야 함
+			if (!backtrack())
+				return SearchResult::NotFound;
+			continue;
+		}
+
+		const auto op = entries[e].op;
+		bool next_state;
+		if (step(state, ops[op], next_state))
+		{
+			bits[op / 64] |= uint64_t{1} << (op % 64);
+			auto key = bits;
+			if (next_state)
+				key.back() |= state_bit;
+			if (cache.insert(std::move(key)).second)
+			{
+				calls.emplace_back(e, state);
+				state = next_state;
+				unlink(e);
+				unlink(match[e]);
+				e = next[head];
+				continue;
+			}
+			bits[op / 64] &= ~(uint64_t{1} << (op % 64));
+		}
+		e = next[e];
+	}
+}
+} // namespace history_detail
+
+// recorder의 history가 set으로서 linearizable인지 검사한다.
+// key마다 응답 전에 다음 호출이 없는 시점(아무 연산도 진행 중이지 않은 시점)에서 잘라 작은 조각으로 나누고,
+// 조각이 끝날 수 있는 상태들을 다음 조각의 시작 상태로 넘긴다. max_steps는 조각 하나의 탐색 한도.
+inline LinearizabilityReport check_set_linearizability(const HistoryRecorder &recorder, size_t max_steps = size_t{1} << 24)
+{
+	using namespace history_detail;
+
+	LinearizabilityReport report;
+	report.truncated = recorder.truncated();
+	auto events = recorder.events();
+	report.num_ops = events.size();
+	if (report.truncated)
+		return report;
+
+	std::sort(events.begin(), events.end(), [](const HistoryEvent &a, const HistoryEvent &b) {
+		return a.key != b.key ? a.key < b.key : a.invoke_ns < b.invoke_ns;
+	});
+	std::unordered_set<int> initial(recorder.initial_keys().begin(), recorder.initial_keys().end());
+
+	std::vector<HistoryEvent> segment;
+	for (size_t begin = 0; begin < events.size();)
+	{
+		const auto key = events[begin].key;
+		auto end = begin;
+		while (end < events.size() && events[end].key == key)
+			++end;
+		++report.num_keys;
+
+		// 가능한 상태 집합. bit 0 = 없음, bit 1 = 있음
+		unsigned possible = initial.count(key) ? 2u : 1u;
+		bool exhausted = false;
+		for (auto i = begin; i < end && possible != 0;)
+		{
+			segment.clear();
+			auto last_response = events[i].response_ns;
+			while (i < end && (segment.empty() || events[i].invoke_ns <= last_response))
+			{
+				last_response = std::max(last_response, events[i].response_ns);
+				segment.push_back(events[i++]);
+			}
+
+			unsigned reachable = 0;
+			for (auto target = 0; target < 2; ++target)
+			{
+				for (auto start = 0; start < 2; ++start)
+				{
+					if ((possible & (1u << start)) == 0 || (reachable & (1u << target)) != 0)
+						continue;
+					size_t steps = 0;
+					const auto result = search(segment, start == 1, target == 1, steps, max_steps);
+					if (result == SearchResult::Found)
+						reachable |= 1u << target;
+					else if (result == SearchResult::Exhausted)
+						exhausted = true;
+				}
+			}
+			possible = reachable;
+		}
+
+		if (possible == 0)
+		{
+			if (exhausted)
+				report.undecided_keys.push_back(key);
+			else
+				report.bad_keys.push_back(key);
+		}
+		begin = end;
+	}
+	return report;
+}
+
+#endif /* A9E34C71_5B28_4D6F_8C13_E0B7F52A94D6 */
@@ -0,0 +1,185 @@
+#ifndef C6E2D5A8_1F47_4B93_8A0C_E7D41B96F235
+#define C6E2D5A8_1F47_4B93_8A0C_E7D41B96F235
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// 벤치마크들이 같이 쓰는 key 분포와 thread별 난수 생성기.
+
+enum class KeyDist
+{
+	Uniform,
+	// YCSB와 같은 방식의 Zipfian. 순위를 hash해서 인기 있는 key가 한 곳에 몰리지 않게 함.
+	Zipf,
+	// 전체 key 중 hot_keys 비율만큼이 연산의 hot_ops 비율을 차지
+	Hotspot,
+};
+
+inline const char *to_string(KeyDist dist)
+{
+	switch (dist)
+	{
+	case KeyDist::Uniform:
+		return "uniform";
+	case KeyDist::Zipf:
+		return "zipf";
+	case KeyDist::Hotspot:
+		return "hotspot";
+	}
+	return "unknown";
+}
+
+// key 범위와 분포. 값을 바꾼 뒤에는 prepare()를 불러야 Zipf 분포에 쓰는 값이 갱신된다.
+struct KeySpace
+{
+	int key_range = 1000;
+	KeyDist dist = KeyDist::Uniform;
+	double zipf_theta = 0.99;
+	double hot_keys = 0.2;
+	double hot_ops = 0.8;
+
+	// Zipf 분포에 쓰는 값들. prepare에서 한 번만 계산
+	double zipf_zetan = 0;
+	double zipf_alpha = 0;
+	double zipf_eta = 0;
+
+	// 분포 인자가 올바르지 않으면 false
+	bool prepare()
+	{
+		if (key_range < 1 || hot_keys <= 0 || 1 < hot_keys || hot_ops < 0 || 1 < hot_ops)
+			return false;
+		if (dist != KeyDist::Zipf)
+			return true;
+
+		const auto theta = zipf_theta;
+		if (theta <= 0 || theta == 1.0)
+			return false;
+		double zeta2 = 1.0 + std::pow(0.5, theta);
+		double zetan = 0;
+		for (auto i = 1; i <= key_range; ++i)
+			zetan += 1.0 / std::pow(i, theta);
+		zipf_zetan = zetan;
+		zipf_alpha = 1.0 / (1.0 - theta);
+		zipf_eta = (1.0 - std::pow(2.0 / key_range, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+		return true;
+	}
+};
+
+// thread마다 하나씩 두고 key를 만든다. 난수 상태를 thread별로 따로 가지므로 공유 메모리에 쓰지 않음.
+class KeyGenerator
+{
+public:
+	KeyGenerator(const KeySpace &keys, int thread_id) : keys{keys}, state{0x9E3779B97F4A7C15ull * (thread_id + 1)} {}
+
+	int next_key()
+	{
+		const auto range = static_cast<uint64_t>(keys.key_range);
+		switch (keys.dist)
+		{
+		case KeyDist::Zipf:
+			return static_cast<int>(scramble(next_zipf()) % range);
+		case KeyDist::Hotspot:
+		{
+			const auto hot_range = std::max<uint64_t>(1, static_cast<uint64_t>(range * keys.hot_keys));
+			if (next_double() < keys.hot_ops || hot_range == range)
+				return static_cast<int>(next_rand() % hot_range);
+			return static_cast<int>(hot_range + next_rand() % (range - hot_range));
+		}
+		default:
+			return static_cast<int>(next_rand() % range);
+		}
+	}
+
+	uint64_t next_rand()
+	{
+		// xorshift64*
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1Dull;
+	}
+
+	double next_double()
+	{
+		return (next_rand() >> 11) * (1.0 / (1ull << 53));
+	}
+
+private:
+	// Gray et al. "Quickly generating billion-record synthetic databases"의 방법. 0이 가장 인기 있는 순위.
+	uint64_t next_zipf()
+	{
+		const auto u = next_double();
+		const auto uz = u * keys.zipf_zetan;
+		if (uz < 1.0)
+			return 0;
+		if (uz < 1.0 + std::pow(0.5, keys.zipf_theta))
+			return 1;
+		return static_cast<uint64_t>(keys.key_range * std::pow(keys.zipf_eta * u - keys.zipf_eta + 1.0, keys.zipf_alpha));
+	}
+
+	static uint64_t scramble(uint64_t rank)
+	{
+		rank ^= rank >> 33;
+		rank *= 0xFF51AFD7ED558CCDull;
+		rank ^= rank >> 33;
+		return rank;
+	}
+
+	const KeySpace &keys;
+	uint64_t state;
+};
+
+inline std::vector<std::string> split(const std::string &str, char delim)
+{
+	std::vector<std::string> tokens;
+	size_t begin = 0;
+	while (true)
+	{
+		const auto end = str.find(delim, begin);
+		tokens.push_back(str.substr(begin, end - begin));
+		if (end == std::string::npos)
+			return tokens;
+		begin = end + 1;
+	}
+}
+
+// --keys, --dist, --zipf, --hot 인자. 이름이 맞으면 true를 돌려주고 값이 올바른지는 ok에 기록
+inline bool parse_key_option(const std::string &name, const std::string &value, KeySpace &keys, bool &ok)
+{
+	ok = true;
+	if (name == "keys")
+		keys.key_range = std::atoi(value.c_str());
+	else if (name == "dist")
+	{
+		if (value == "uniform")
+			keys.dist = KeyDist::Uniform;
+		else if (value == "zipf")
+			keys.dist = KeyDist::Zipf;
+		else if (value == "hotspot")
+			keys.dist = KeyDist::Hotspot;
+		else
+			ok = false;
+	}
+	else if (name == "zipf")
+		keys.zipf_theta = std::atof(value.c_str());
+	else if (name == "hot")
+	{
+		const auto tokens = split(value, ':');
+		if (tokens.size() != 2)
+			ok = false;
+		else
+		{
+			keys.hot_keys = std::atof(tokens[0].c_str()) / 100;
+			keys.hot_ops = std::atof(tokens[1].c_str()) / 100;
+		}
+	}
+	else
+		return false;
+	return true;
+}
+
+#endif /* C6E2D5A8_1F47_4B93_8A0C_E7D41B96F235 */
@@ -0,0 +1,188 @@
+#ifndef B7C41E58_2D93_4F0A_A6E1_5F08C3D92B74
+#define B7C41E58_2D93_4F0A_A6E1_5F08C3D92B74
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 모든 벤치마크가 같이 쓰는 연산별 latency 측정 도구.
+// CMake 프로젝트는 include 경로에 common/을 추가하고, VS 프로젝트는 상대 경로로 include 한다.
+// 시간은 steady_clock으로 잰다. rdtsc보다 약간 느리지만 CPU 주파수 보정이 필요 없고 core를 옮겨도 단조 증가함.
+
+using LatencyClock = std::chrono::steady_clock;
+
+// HDR histogram처럼 2의 거듭제곱 구간마다 SUB_BUCKETS개로 나눠서 세는 latency histogram (단위 ns).
+// 상대 오차는 1/SUB_BUCKETS 이하이고 크기가 고정이라 측정 중에 할당이 없다.
+// thread마다 하나씩 두고 기록한 뒤 마지막에 merge해서 사용.
+class alignas(64) LatencyHistogram
+{
+	static constexpr int SUB_BITS = 4;
+	static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BITS;
+	static constexpr int NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+public:
+	void record(uint64_t ns)
+	{
+		++counts[bucket_of(ns)];
+		++total;
+		if (max_ns < ns)
+			max_ns = ns;
+	}
+
+	void record_since(LatencyClock::time_point begin)
+	{
+		record(std::chrono::duration_cast<std::chrono::nanoseconds>(LatencyClock::now() - begin).count());
+	}
+
+	void merge(const LatencyHistogram &other)
+	{
+		for (auto i = 0; i < NUM_BUCKETS; ++i)
+			counts[i] += other.counts[i];
+		total += other.total;
+		if (max_ns < other.max_ns)
+			max_ns = other.max_ns;
+	}
+
+	void reset()
+	{
+		counts.fill(0);
+		total = 0;
+		max_ns = 0;
+	}
+
+	// 전체의 ratio(0~1)만큼이 포함되는 가장 작은 bucket의 상한값
+	uint64_t percentile(double ratio) const
+	{
+		if (total == 0)
+			return 0;
+		auto rank = static_cast<uint64_t>(ratio * total);
+		if (rank >= total)
+			rank = total - 1;
+
+		uint64_t seen = 0;
+		for (auto i = 0; i < NUM_BUCKETS; ++i)
+		{
+			seen += counts[i];
+			if (seen > rank)
+				return upper_bound_of(i) < max_ns ? upper_bound_of(i) : max_ns;
+		}
+		return max_ns;
+	}
+
+	uint64_t count() const
+	{
+		return total;
+	}
+
+	uint64_t max() const
+	{
+		return max_ns;
+	}
+
+private:
+	static int highest_bit(uint64_t v)
+	{
+#if defined(_MSC_VER)
+		unsigned long idx;
+		if (v >> 32)
+		{
+			_BitScanReverse(&idx, static_cast<unsigned long>(v >> 32));
+			return static_cast<int>(idx) + 32;
+		}
+		_BitScanReverse(&idx, static_cast<unsigned long>(v));
+		return static_cast<int>(idx);
+#else
+		return 63 - __builtin_clzll(v);
+#endif
+	}
+
+	static int bucket_of(uint64_t ns)
+	{
+		if (ns < SUB_BUCKETS)
+			return static_cast<int>(ns);
+		const int shift = highest_bit(ns) - SUB_BITS;
+		return (shift + 1) * SUB_BUCKETS + static_cast<int>((ns >> shift) - SUB_BUCKETS);
+	}
+
+	static uint64_t upper_bound_of(int bucket)
+	{
+		if (bucket < static_cast<int>(SUB_BUCKETS))
+			return bucket;
+		const int shift = bucket / SUB_BUCKETS - 1;
+		const uint64_t sub = bucket % SUB_BUCKETS;
+		return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+	}
+
+	std::array<uint64_t, NUM_BUCKETS> counts{};
+	uint64_t total = 0;
+	uint64_t max_ns = 0;
+};
+
+// 연산 종류(Add/Remove/Contains, push/pop 등)마다 histogram을 하나씩 가진 thread별 기록.
+// 보통 전역 배열로 thread 수만큼 두고, thread 함수 시작에서 reset, 연산마다 record, join 후 print_latency로 출력한다.
+template <size_t NUM_OPS>
+class OpLatency
+{
+public:
+	void record(size_t op, LatencyClock::time_point begin)
+	{
+		hists[op].record_since(begin);
+	}
+
+	void reset()
+	{
+		for (auto &h : hists)
+			h.reset();
+	}
+
+	void merge(const OpLatency &other)
+	{
+		for (size_t i = 0; i < NUM_OPS; ++i)
+			hists[i].merge(other.hists[i]);
+	}
+
+	const LatencyHistogram &operator[](size_t op) const
+	{
+		return hists[op];
+	}
+
+	// 모든 연산을 합친 histogram
+	LatencyHistogram total() const
+	{
+		LatencyHistogram sum;
+		for (auto &h : hists)
+			sum.merge(h);
+		return sum;
+	}
+
+private:
+	std::array<LatencyHistogram, NUM_OPS> hists;
+};
+
+inline void print_latency_line(std::ostream &os, const char *name, const LatencyHistogram &h)
+{
+	os << "    " << name << " : ";
+	os << "p50 " << h.percentile(0.5) << " ns,  ";
+	os << "p99 " << h.percentile(0.99) << " ns,  ";
+	os << "p99.9 " << h.percentile(0.999) << " ns,  ";
+	os << "max " << h.max() << " ns  (" << h.count() << " ops)\n";
+}
+
+// thread별 기록 num_thread개를 합쳐서 연산마다 한 줄씩 출력
+template <size_t NUM_OPS>
+void print_latency(std::ostream &os, const OpLatency<NUM_OPS> *per_thread, int num_thread, const char *const (&names)[NUM_OPS])
+{
+	static OpLatency<NUM_OPS> merged;
+	merged.reset();
+	for (auto i = 0; i < num_thread; ++i)
+		merged.merge(per_thread[i]);
+	for (size_t op = 0; op < NUM_OPS; ++op)
+		print_latency_line(os, names[op], merged[op]);
+}
+
+#endif /* B7C41E58_2D93_4F0A_A6E1_5F08C3D92B74 */
@@ -0,0 +1,349 @@
+#ifndef F2B7A9C4_6D31_4E85_A0C2_93E5D18B7F46
+#define F2B7A9C4_6D31_4E85_A0C2_93E5D18B7F46
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+
+// /sys/devices/system/cpu에서 CPU 배치(NUMA node, package, core, SMT)를 읽고 측정 thread를 정해진 CPU에 고정한다.
+// hyper-threading 유무나 node당 core 수를 가정하지 않으므로 SMT가 꺼진 machine에서도 같은 규칙으로 배치된다.
+
+// 측정 thread를 어느 CPU에 고정할지 정하는 방법
+enum class PinPolicy
+{
+	// 고정하지 않고 OS에 맡김
+	None,
+	// node를 하나씩 채움. node 안에서는 physical core마다 하나씩 먼저 쓰고 남으면 SMT sibling을 씀
+	Compact,
+	// NUMA node를 번갈아가며 하나씩 배치. node 안의 순서는 Compact와 같음
+	Scatter,
+	// node를 하나씩 채우되 한 core의 SMT sibling을 모두 쓴 뒤에 다음 core로 넘어감
+	SmtFirst,
+};
+
+inline const char *to_string(PinPolicy policy)
+{
+	switch (policy)
+	{
+	case PinPolicy::None:
+		return "none";
+	case PinPolicy::Compact:
+		return "compact";
+	case PinPolicy::Scatter:
+		return "scatter";
+	case PinPolicy::SmtFirst:
+		return "smt";
+	}
+	return "unknown";
+}
+
+inline bool parse_pin_policy(const std::string &value, PinPolicy &policy)
+{
+	if (value == "none")
+		policy = PinPolicy::None;
+	else if (value == "compact")
+		policy = PinPolicy::Compact;
+	else if (value == "scatter")
+		policy = PinPolicy::Scatter;
+	else if (value == "smt" || value == "smt-first")
+		policy = PinPolicy::SmtFirst;
+	else
+		return false;
+	return true;
+}
+
+struct CpuInfo
+{
+	int cpu;
+	int node;
+	int package;
+	// package 안에서의 physical core 번호
+	int core;
+	// 같은 core의 hardware thread 중 몇 번째인지. SMT가 없으면 항상 0
+	int smt;
+};
+
+class CpuTopology
+{
+public:
+	// 이 process가 쓸 수 있는 CPU만 포함. 처음 한 번만 sysfs를 읽음
+	static const CpuTopology &get()
+	{
+		static const CpuTopology topology;
+		return topology;
+	}
+
+	const std::vector<CpuInfo> &cpus() const
+	{
+		return cpu_list;
+	}
+	int num_nodes() const
+	{
+		return static_cast<int>(node_ids.size());
+	}
+	int num_cores() const
+	{
+		return core_count;
+	}
+	// 모르는 CPU이면 0
+	int node_of(int cpu) const
+	{
+		for (auto &info : cpu_list)
+		{
+			if (info.cpu == cpu)
+				return info.node;
+		}
+		return 0;
+	}
+
+	// thread i가 order[i % order.size()]에 고정되도록 CPU 번호를 나열한다. None이면 비어 있음
+	std::vector<int> order(PinPolicy policy) const
+	{
+		std::vector<CpuInfo> sorted = cpu_list;
+		switch (policy)
+		{
+		case PinPolicy::None:
+			return {};
+		case PinPolicy::SmtFirst:
+			std::sort(sorted.begin(), sorted.end(), [](const CpuInfo &a, const CpuInfo &b) {
+				return std::tie(a.node, a.package, a.core, a.smt, a.cpu) < std::tie(b.node, b.package, b.core, b.smt, b.cpu);
+			});
+			break;
+		case PinPolicy::Compact:
+		case PinPolicy::Scatter:
+			std::sort(sorted.begin(), sorted.end(), [](const CpuInfo &a, const CpuInfo &b) {
+				return std::tie(a.node, a.smt, a.package, a.core, a.cpu) < std::tie(b.node, b.smt, b.package, b.core, b.cpu);
+			});
+			break;
+		}
+
+		std::vector<int> cpus;
+		if (policy != PinPolicy::Scatter)
+		{
+			for (auto &info : sorted)
+				cpus.push_back(info.cpu);
+			return cpus;
+		}
+
+		std::map<int, std::vector<int>> per_node;
+		for (auto &info : sorted)
+			per_node[info.node].push_back(info.cpu);
+		for (size_t i = 0; cpus.size() < sorted.size(); ++i)
+		{
+			for (auto &node_cpus : per_node)
+			{
+				if (i < node_cpus.second.size())
+					cpus.push_back(node_cpus.second[i]);
+			}
+		}
+		return cpus;
+	}
+
+	// order대로 num_thread개를 배치했을 때 쓰이는 node 수. 고정하지 않으면 모든 node
+	int nodes_spanned(const std::vector<int> &order, int num_thread) const
+	{
+		if (order.empty())
+			return num_nodes();
+		std::vector<int> nodes;
+		for (auto i = 0; i < num_thread && i < static_cast<int>(order.size()); ++i)
+		{
+			const auto node = node_of(order[i]);
+			if (std::find(nodes.begin(), nodes.end(), node) == nodes.end())
+				nodes.push_back(node);
+		}
+		return std::max(static_cast<int>(nodes.size()), 1);
+	}
+
+	void describe(std::ostream &os) const
+	{
+		os << "Topology : " << num_nodes() << " node(s), " << num_cores() << " core(s), " << cpu_list.size() << " CPU(s)";
+		if (!from_sysfs)
+			os << " (sysfs unavailable, assuming one node without SMT)";
+		os << std::endl;
+	}
+
+private:
+	CpuTopology()
+	{
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		sched_getaffinity(0, sizeof(allowed), &allowed);
+
+		from_sysfs = true;
+		for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (!CPU_ISSET(cpu, &allowed))
+				continue;
+			const auto dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+			CpuInfo info{cpu, read_node(dir), read_int(dir + "/topology/physical_package_id"), read_int(dir + "/topology/core_id"), 0};
+			if (info.package < 0 || info.core < 0)
+			{
+				// sysfs가 없으면 CPU마다 별도의 core로 봄
+				from_sysfs = false;
+				info.package = 0;
+				info.core = cpu;
+			}
+			const auto siblings = read_cpu_list(dir + "/topology/thread_siblings_list");
+			info.smt = static_cast<int>(std::find(siblings.begin(), siblings.end(), cpu) - siblings.begin());
+			if (info.smt == static_cast<int>(siblings.size()))
+				info.smt = 0;
+			cpu_list.push_back(info);
+		}
+
+		std::vector<std::pair<int, int>> cores;
+		for (auto &info : cpu_list)
+		{
+			if (std::find(node_ids.begin(), node_ids.end(), info.node) == node_ids.end())
+				node_ids.push_back(info.node);
+			if (std::find(cores.begin(), cores.end(), std::make_pair(info.package, info.core)) == cores.end())
+				cores.emplace_back(info.package, info.core);
+		}
+		if (node_ids.empty())
+			node_ids.push_back(0);
+		core_count = std::max(static_cast<int>(cores.size()), 1);
+	}
+
+	// 없으면 -1
+	static int read_int(const std::string &path)
+	{
+		auto fp = fopen(path.c_str(), "r");
+		if (fp == nullptr)
+			return -1;
+		int value = -1;
+		if (fscanf(fp, "%d", &value) != 1)
+			value = -1;
+		fclose(fp);
+		return value;
+	}
+
+	// "0-3,8,10-11" 형식
+	static std::vector<int> read_cpu_list(const std::string &path)
+	{
+		std::vector<int> cpus;
+		auto fp = fopen(path.c_str(), "r");
+		if (fp == nullptr)
+			return cpus;
+		int first, last;
+		while (fscanf(fp, "%d", &first) == 1)
+		{
+			last = first;
+			auto c = fgetc(fp);
+			if (c == '-')
+			{
+				if (fscanf(fp, "%d", &last) != 1)
+					break;
+				c = fgetc(fp);
+			}
+			for (auto cpu = first; cpu <= last; ++cpu)
+				cpus.push_back(cpu);
+			if (c != ',')
+				break;
+		}
+		fclose(fp);
+		return cpus;
+	}
+
+	// cpuN 폴더 안의 nodeM link가 CPU가 속한 node. NUMA가 없는 kernel이면 0
+	static int read_node(const std::string &cpu_dir)
+	{
+		auto dir = opendir(cpu_dir.c_str());
+		if (dir == nullptr)
+			return 0;
+		auto node = 0;
+		while (auto entry = readdir(dir))
+		{
+			int id;
+			if (sscanf(entry->d_name, "node%d", &id) == 1)
+			{
+				node = id;
+				break;
+			}
+		}
+		closedir(dir);
+		return node;
+	}
+
+	std::vector<CpuInfo> cpu_list;
+	std::vector<int> node_ids;
+	int core_count = 1;
+	bool from_sysfs = false;
+};
+
+// 호출한 thread를 cpu에 고정
+inline bool pin_to_cpu(int cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// 호출한 thread가 cpus 중 아무 곳에서나 돌도록 제한. 비어 있으면 아무것도 하지 않음
+inline bool pin_to_cpus(const std::vector<int> &cpus)
+{
+	if (cpus.empty())
+		return true;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto cpu : cpus)
+		CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// 측정 thread가 실제로 돈 CPU와 node. 측정이 끝날 때 기록하므로 고정하지 않은 thread는 마지막 위치
+struct ThreadPlacement
+{
+	int cpu = -1;
+	int node = -1;
+
+	static ThreadPlacement current()
+	{
+		const auto cpu = sched_getcpu();
+		return ThreadPlacement{cpu, cpu < 0 ? -1 : CpuTopology::get().node_of(cpu)};
+	}
+};
+
+// thread_id를 order에 따라 고정하고 실패하면 stderr에 남긴다. order가 비어 있으면 아무것도 하지 않음
+inline void pin_thread(const std::vector<int> &order, int thread_id)
+{
+	if (order.empty())
+		return;
+	const auto cpu = order[thread_id % order.size()];
+	if (!pin_to_cpu(cpu))
+		fprintf(stderr, "Can't pin thread #%d to CPU #%d\n", thread_id, cpu);
+}
+
+// "    Placement : #0 cpu0/node0, #1 cpu2/node0, ..."
+template <typename Iterator>
+void print_placement(std::ostream &os, Iterator begin, Iterator end)
+{
+	os << "    Placement : ";
+	auto thread_id = 0;
+	for (auto it = begin; it != end; ++it, ++thread_id)
+	{
+		if (thread_id != 0)
+			os << ", ";
+		os << '#' << thread_id << " cpu" << it->cpu << "/node" << it->node;
+	}
+	os << std::endl;
+}
+
+// CSV/JSON에 넣는 형식. thread 순서대로 "cpu/node"를 ';'로 이음
+template <typename Iterator>
+std::string placement_string(Iterator begin, Iterator end)
+{
+	std::string placement;
+	for (auto it = begin; it != end; ++it)
+		placement += (placement.empty() ? "" : ";") + std::to_string(it->cpu) + '/' + std::to_string(it->node);
+	return placement;
+}
+
+#endif /* F2B7A9C4_6D31_4E85_A0C2_93E5D18B7F46 */
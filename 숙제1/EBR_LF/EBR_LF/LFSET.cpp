@@ -8,6 +8,7 @@
 #include <atomic>
 #include <climits>
 #include <algorithm>
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace chrono;
@@ -280,23 +281,33 @@ public:
 
 LFSET my_set;
 
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[MAX_THREAD];
+
 void benchmark(int num_thread, int thread_id)
 {
 	tid = thread_id;
 	retired_list.clear();
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; ++i)
 	{
 		//	if (0 == i % 100000) cout << ".";
+		const auto op_begin = LatencyClock::now();
 		switch (rand() % 3)
 		{
 		case 0:
 			my_set.Add(rand() % RANGE);
+			latency.record(OP_ADD, op_begin);
 			break;
 		case 1:
 			my_set.Remove(rand() % RANGE);
+			latency.record(OP_REMOVE, op_begin);
 			break;
 		case 2:
 			my_set.Contains(rand() % RANGE);
+			latency.record(OP_CONTAINS, op_begin);
 			break;
 		default:
 			cout << "ERROR!!!\n";
@@ -332,5 +343,6 @@ int main()
 
 		cout << num_thread << " Threads,  Time = ";
 		cout << duration_cast<milliseconds>(du).count() << " ms\n";
+		print_latency(cout, latencies, num_thread, SET_OP_NAMES);
 	}
 }
@@ -6,6 +6,7 @@
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace chrono;
@@ -109,51 +110,56 @@ class LFSKNode
 {
 public:
 	int key;
-	LFSKNode* volatile next[MAX_LEVEL];
 	int topLevel;
 	atomic_uint ref_count;
+	// 실제 높이만큼만 할당하는 가변 길이 tower. key와 next[0]이 node 앞쪽에 모이도록 맨 뒤에 둠
+	LFSKNode* volatile next[];
 
 	// 보초노드에 관한 생성자
-	LFSKNode() : ref_count{ MAX_LEVEL } {
-		for (int i = 0; i < MAX_LEVEL; i++) {
-			next[i] = AtomicMarkableReference(NULL, false);
-		}
-		topLevel = MAX_LEVEL;
-	}
 	LFSKNode(int myKey) : ref_count{ MAX_LEVEL } {
 		key = myKey;
+		topLevel = MAX_LEVEL;
 		for (int i = 0; i < MAX_LEVEL; i++) {
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
-		topLevel = MAX_LEVEL;
 	}
 
 	// 일반노드에 관한 생성자
 	LFSKNode(int x, int height) : ref_count{ height + 1 } {
 		key = x;
-		for (int i = 0; i < MAX_LEVEL; i++) {
-			next[i] = AtomicMarkableReference(NULL, false);
-		}
 		topLevel = height;
-	}
-
-	void InitNode() {
-		key = 0;
-		for (int i = 0; i < MAX_LEVEL; i++) {
+		for (int i = 0; i < Height(height); i++) {
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
-		topLevel = MAX_LEVEL;
 	}
 
+	// top은 할당할 때 넘긴 topLevel과 같아야 함
 	void InitNode(int x, int top) {
 		key = x;
-		for (int i = 0; i < MAX_LEVEL; i++) {
+		for (int i = 0; i < Height(top); i++) {
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
 		topLevel = top;
 		ref_count.store(top + 1, memory_order_relaxed);
 	}
 
+	// topLevel이 top인 node의 next 칸 수. 보초노드는 top이 MAX_LEVEL
+	static int Height(int top) {
+		return top < MAX_LEVEL ? top + 1 : MAX_LEVEL;
+	}
+
+	// new (topLevel) LFSKNode(...)로 만들면 next를 topLevel층까지만 할당한다. delete는 그대로 쓰면 됨
+	static void* operator new(size_t size, int top) {
+		return ::operator new(size + Height(top) * sizeof(LFSKNode*));
+	}
+	static void operator delete(void* p) {
+		::operator delete(p);
+	}
+	// 생성자에서 예외가 나면 불림
+	static void operator delete(void* p, int) {
+		::operator delete(p);
+	}
+
 	bool CompareAndSet(int level, LFSKNode* old_node, LFSKNode* next_node, bool old_mark, bool next_mark) {
 		int old_addr = reinterpret_cast<int>(old_node);
 		if (old_mark) old_addr = old_addr | 0x1;
@@ -175,8 +181,8 @@ public:
 	LFSKNode* tail;
 
 	LFSKSET() {
-		head = new LFSKNode(0x80000000);
-		tail = new LFSKNode(0x7FFFFFFF);
+		head = new (MAX_LEVEL) LFSKNode(0x80000000);
+		tail = new (MAX_LEVEL) LFSKNode(0x7FFFFFFF);
 		for (int i = 0; i < MAX_LEVEL; i++) {
 			head->next[i] = AtomicMarkableReference(tail, false);
 		}
@@ -273,7 +279,7 @@ public:
 		int bottomLevel = 0;
 		LFSKNode* preds[MAX_LEVEL];
 		LFSKNode* succs[MAX_LEVEL];
-		LFSKNode* newNode = new LFSKNode;
+		LFSKNode* newNode = new (topLevel) LFSKNode(x, topLevel);
 		while (true) {
 			bool found = Find(x, preds, succs);
 			// 대상 키를 갖는 표시되지 않은 노드를 찾으면 키가 이미 집합에 있으므로 false 반환
@@ -447,15 +453,22 @@ public:
 
 LFSKSET my_set;
 
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[MAX_THREAD];
+
 void benchmark(int num_thread, int thread_id)
 {
 	tid = thread_id;
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; ++i) {
 		//	if (0 == i % 100000) cout << ".";
+		const auto op_begin = LatencyClock::now();
 		switch (rand() % 3) {
-		case 0: my_set.Add(rand() % RANGE); break;
-		case 1: my_set.Remove(rand() % RANGE); break;
-		case 2: my_set.Contains(rand() % RANGE); break;
+		case 0: my_set.Add(rand() % RANGE); latency.record(OP_ADD, op_begin); break;
+		case 1: my_set.Remove(rand() % RANGE); latency.record(OP_REMOVE, op_begin); break;
+		case 2: my_set.Contains(rand() % RANGE); latency.record(OP_CONTAINS, op_begin); break;
 		default: cout << "ERROR!!!\n"; exit(-1);
 		}
 	}
@@ -484,5 +497,6 @@ int main()
 
 		cout << num_thread << " Threads,  Time = ";
 		cout << duration_cast<milliseconds>(du).count() << " ms\n";
+		print_latency(cout, latencies, num_thread, SET_OP_NAMES);
 	}
 }
@@ -4,6 +4,7 @@
 #include <atomic>
 #include <mutex>
 #include <vector>
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -168,15 +169,24 @@ public:
 const auto NUM_TEST = 10000000;
 
 LFQUEUE my_queue;
+enum QueueOp { OP_ENQ, OP_DEQ, NUM_QUEUE_OP };
+const char* const QUEUE_OP_NAMES[NUM_QUEUE_OP] = { "Enq", "Deq" };
+OpLatency<NUM_QUEUE_OP> latencies[MAX_THREAD];
+
 void ThreadFunc(int num_thread, int thread_id)
 {
 	tid = thread_id;
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; i++) {
+		const auto op_begin = LatencyClock::now();
 		if ((rand() % 2 == 0) || (i < (10000 / num_thread))) {
 			my_queue.Enq(i);
+			latency.record(OP_ENQ, op_begin);
 		}
 		else {
 			int key = my_queue.Deq();
+			latency.record(OP_DEQ, op_begin);
 		}
 	}
 }
@@ -202,5 +212,6 @@ int main()
 		//my_queue.recycle_freelist();
 		cout << n << "Threads,  ";
 		cout << ",  Duration : " << duration_cast<milliseconds>(d).count() << " msecs.\n";
+		print_latency(cout, latencies, n, QUEUE_OP_NAMES);
 	}
 }
@@ -9,6 +9,7 @@
 #include <tuple>
 #include <array>
 #include "hazard_ptr.h"
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace chrono;
@@ -62,55 +63,38 @@ class LFSKNode
 {
 public:
 	int key;
-	LFSKNode* next[MAX_LEVEL];
 	int topLevel;
 	atomic_uint ref_count;
+	//  ̸ŭ Ҵϴ   tower. key next[0] node ʿ ̵  ڿ 
+	LFSKNode* next[];
 
 	// ʳ忡  
-	LFSKNode() : ref_count{ MAX_LEVEL }
-	{
-		for (int i = 0; i < MAX_LEVEL; i++)
-		{
-			next[i] = AtomicMarkableReference(NULL, false);
-		}
-		topLevel = MAX_LEVEL;
-	}
 	LFSKNode(int myKey) : ref_count{ MAX_LEVEL }
 	{
 		key = myKey;
+		topLevel = MAX_LEVEL;
 		for (int i = 0; i < MAX_LEVEL; i++)
 		{
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
-		topLevel = MAX_LEVEL;
 	}
 
 	// Ϲݳ忡  
 	LFSKNode(int x, int height) : ref_count{ height + 1 }
 	{
 		key = x;
-		for (int i = 0; i < MAX_LEVEL; i++)
-		{
-			next[i] = AtomicMarkableReference(NULL, false);
-		}
 		topLevel = height;
-	}
-
-	void InitNode()
-	{
-		key = 0;
-		for (int i = 0; i < MAX_LEVEL; i++)
+		for (int i = 0; i < Height(height); i++)
 		{
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
-		topLevel = MAX_LEVEL;
-		ref_count.store(MAX_LEVEL, memory_order_relaxed);
 	}
 
+	// top Ҵ  ѱ topLevel ƾ 
 	void InitNode(int x, int top)
 	{
 		key = x;
-		for (int i = 0; i < MAX_LEVEL; i++)
+		for (int i = 0; i < Height(top); i++)
 		{
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
@@ -118,6 +102,27 @@ public:
 		ref_count.store(top + 1, memory_order_relaxed);
 	}
 
+	// topLevel top node next ĭ . ʳ top MAX_LEVEL
+	static int Height(int top)
+	{
+		return top < MAX_LEVEL ? top + 1 : MAX_LEVEL;
+	}
+
+	// new (topLevel) LFSKNode(...)  next topLevel ҴѴ. delete ״  
+	static void* operator new(size_t size, int top)
+	{
+		return ::operator new(size + Height(top) * sizeof(LFSKNode*));
+	}
+	static void operator delete(void* p)
+	{
+		::operator delete(p);
+	}
+	// ڿ ܰ  Ҹ
+	static void operator delete(void* p, int)
+	{
+		::operator delete(p);
+	}
+
 	bool CompareAndSet(int level, LFSKNode* old_node, LFSKNode* next_node, bool old_mark, bool next_mark)
 	{
 		int old_addr = reinterpret_cast<int>(old_node);
@@ -151,8 +156,8 @@ public:
 
 	LFSKSET()
 	{
-		head = new LFSKNode(0x80000000);
-		tail = new LFSKNode(0x7FFFFFFF);
+		head = new (MAX_LEVEL) LFSKNode(0x80000000);
+		tail = new (MAX_LEVEL) LFSKNode(0x7FFFFFFF);
 		for (int i = 0; i < MAX_LEVEL; i++)
 		{
 			head->next[i] = AtomicMarkableReference(tail, false);
@@ -270,7 +275,7 @@ public:
 		int bottomLevel = 0;
 		LFSKNode* preds[MAX_LEVEL];
 		LFSKNode* succs[MAX_LEVEL];
-		LFSKNode* newNode = new LFSKNode;
+		LFSKNode* newNode = new (topLevel) LFSKNode(x, topLevel);
 
 		auto hp_new = hp_list.acq_guard();
 		hp_new->set_hp(newNode);
@@ -441,7 +446,11 @@ public:
 
 LFSKSET my_set;
 
-void benchmark(int num_thread)
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[32];
+
+void benchmark(int num_thread, int thread_id)
 {
 	for (auto& hp : local_hps) {
 		hp = hp_list.acq_guard();
@@ -453,19 +462,25 @@ void benchmark(int num_thread)
 		hp = hp_list.acq_guard();
 	}
 
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; ++i)
 	{
 		//	if (0 == i % 100000) cout << ".";
+		const auto op_begin = LatencyClock::now();
 		switch (rand() % 3)
 		{
 		case 0:
 			my_set.Add(rand() % RANGE);
+			latency.record(OP_ADD, op_begin);
 			break;
 		case 1:
 			my_set.Remove(rand() % RANGE);
+			latency.record(OP_REMOVE, op_begin);
 			break;
 		case 2:
 			my_set.Contains(rand() % RANGE);
+			latency.record(OP_CONTAINS, op_begin);
 			break;
 		default:
 			cout << "ERROR!!!\n";
@@ -484,7 +499,7 @@ int main()
 
 		auto start_t = high_resolution_clock::now();
 		for (int i = 0; i < num_thread; ++i)
-			worker.push_back(thread{ benchmark, num_thread });
+			worker.push_back(thread{ benchmark, num_thread, i });
 		for (auto& th : worker)
 			th.join();
 		auto du = high_resolution_clock::now() - start_t;
@@ -492,5 +507,6 @@ int main()
 
 		cout << num_thread << " Threads,  Time = ";
 		cout << duration_cast<milliseconds>(du).count() << " ms" << endl;
+		print_latency(cout, latencies, num_thread, SET_OP_NAMES);
 	}
 }
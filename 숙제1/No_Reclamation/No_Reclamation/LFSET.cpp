@@ -6,6 +6,7 @@
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace chrono;
@@ -172,14 +173,21 @@ public:
 
 LFSET my_set;
 
-void benchmark(int num_thread)
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[32];
+
+void benchmark(int num_thread, int thread_id)
 {
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; ++i) {
 		//	if (0 == i % 100000) cout << ".";
+		const auto op_begin = LatencyClock::now();
 		switch (rand() % 3) {
-		case 0: my_set.Add(rand() % RANGE); break;
-		case 1: my_set.Remove(rand() % RANGE); break;
-		case 2: my_set.Contains(rand() % RANGE); break;
+		case 0: my_set.Add(rand() % RANGE); latency.record(OP_ADD, op_begin); break;
+		case 1: my_set.Remove(rand() % RANGE); latency.record(OP_REMOVE, op_begin); break;
+		case 2: my_set.Contains(rand() % RANGE); latency.record(OP_CONTAINS, op_begin); break;
 		default: cout << "ERROR!!!\n"; exit(-1);
 		}
 	}
@@ -194,13 +202,14 @@ int main()
 
 		auto start_t = high_resolution_clock::now();
 		for (int i = 0; i < num_thread; ++i)
-			worker.push_back(thread{ benchmark, num_thread });
+			worker.push_back(thread{ benchmark, num_thread, i });
 		for (auto& th : worker) th.join();
 		auto du = high_resolution_clock::now() - start_t;
 		my_set.Dump();
 
 		cout << num_thread << " Threads,  Time = ";
 		cout << duration_cast<milliseconds>(du).count() << " ms\n";
+		print_latency(cout, latencies, num_thread, SET_OP_NAMES);
 	}
 	system("pause");
 }
@@ -6,6 +6,7 @@
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace chrono;
@@ -59,47 +60,52 @@ class LFSKNode
 {
 public:
 	int key;
-	LFSKNode* next[MAX_LEVEL];
 	int topLevel;
+	//  ̸ŭ Ҵϴ   tower. key next[0] node ʿ ̵  ڿ 
+	LFSKNode* next[];
 
 	// ʳ忡  
-	LFSKNode() {
-		for (int i = 0; i < MAX_LEVEL; i++) {
-			next[i] = AtomicMarkableReference(NULL, false);
-		}
-		topLevel = MAX_LEVEL;
-	}
 	LFSKNode(int myKey) {
 		key = myKey;
+		topLevel = MAX_LEVEL;
 		for (int i = 0; i < MAX_LEVEL; i++) {
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
-		topLevel = MAX_LEVEL;
 	}
 
 	// Ϲݳ忡  
 	LFSKNode(int x, int height) {
 		key = x;
-		for (int i = 0; i < MAX_LEVEL; i++) {
-			next[i] = AtomicMarkableReference(NULL, false);
-		}
 		topLevel = height;
-	}
-
-	void InitNode() {
-		key = 0;
-		for (int i = 0; i < MAX_LEVEL; i++) {
+		for (int i = 0; i < Height(height); i++) {
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
-		topLevel = MAX_LEVEL;
 	}
 
+	// top Ҵ  ѱ topLevel ƾ 
 	void InitNode(int x, int top) {
 		key = x;
-		for (int i = 0; i < MAX_LEVEL; i++) {
+		topLevel = top;
+		for (int i = 0; i < Height(top); i++) {
 			next[i] = AtomicMarkableReference(NULL, false);
 		}
-		topLevel = top;
+	}
+
+	// topLevel top node next ĭ . ʳ top MAX_LEVEL
+	static int Height(int top) {
+		return top < MAX_LEVEL ? top + 1 : MAX_LEVEL;
+	}
+
+	// new (topLevel) LFSKNode(...)  next topLevel ҴѴ. delete ״  
+	static void* operator new(size_t size, int top) {
+		return ::operator new(size + Height(top) * sizeof(LFSKNode*));
+	}
+	static void operator delete(void* p) {
+		::operator delete(p);
+	}
+	// ڿ ܰ  Ҹ
+	static void operator delete(void* p, int) {
+		::operator delete(p);
 	}
 
 	bool CompareAndSet(int level, LFSKNode* old_node, LFSKNode* next_node, bool old_mark, bool next_mark) {
@@ -123,8 +129,8 @@ public:
 	LFSKNode* tail;
 
 	LFSKSET() {
-		head = new LFSKNode(0x80000000);
-		tail = new LFSKNode(0x7FFFFFFF);
+		head = new (MAX_LEVEL) LFSKNode(0x80000000);
+		tail = new (MAX_LEVEL) LFSKNode(0x7FFFFFFF);
 		for (int i = 0; i < MAX_LEVEL; i++) {
 			head->next[i] = AtomicMarkableReference(tail, false);
 		}
@@ -205,8 +211,7 @@ public:
 				return false;
 			}
 			else {
-				LFSKNode* newNode = new LFSKNode;
-				newNode->InitNode(x, topLevel);
+				LFSKNode* newNode = new (topLevel) LFSKNode(x, topLevel);
 
 				for (int level = bottomLevel; level <= topLevel; level++) {
 					LFSKNode* succ = succs[level];
@@ -331,14 +336,21 @@ public:
 
 LFSKSET my_set;
 
-void benchmark(int num_thread)
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[32];
+
+void benchmark(int num_thread, int thread_id)
 {
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; ++i) {
 		//	if (0 == i % 100000) cout << ".";
+		const auto op_begin = LatencyClock::now();
 		switch (rand() % 3) {
-		case 0: my_set.Add(rand() % RANGE); break;
-		case 1: my_set.Remove(rand() % RANGE); break;
-		case 2: my_set.Contains(rand() % RANGE); break;
+		case 0: my_set.Add(rand() % RANGE); latency.record(OP_ADD, op_begin); break;
+		case 1: my_set.Remove(rand() % RANGE); latency.record(OP_REMOVE, op_begin); break;
+		case 2: my_set.Contains(rand() % RANGE); latency.record(OP_CONTAINS, op_begin); break;
 		default: cout << "ERROR!!!\n"; exit(-1);
 		}
 	}
@@ -353,13 +365,14 @@ int main()
 
 		auto start_t = high_resolution_clock::now();
 		for (int i = 0; i < num_thread; ++i)
-			worker.push_back(thread{ benchmark, num_thread });
+			worker.push_back(thread{ benchmark, num_thread, i });
 		for (auto& th : worker) th.join();
 		auto du = high_resolution_clock::now() - start_t;
 		my_set.Dump();
 
 		cout << num_thread << " Threads,  Time = ";
 		cout << duration_cast<milliseconds>(du).count() << " ms\n";
+		print_latency(cout, latencies, num_thread, SET_OP_NAMES);
 	}
 	system("pause");
 }
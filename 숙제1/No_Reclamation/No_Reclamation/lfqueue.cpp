@@ -4,6 +4,7 @@
 #include <atomic>
 #include <mutex>
 #include <vector>
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -111,14 +112,23 @@ public:
 const auto NUM_TEST = 10000000;
 
 LFQUEUE my_queue;
-void ThreadFunc(int num_thread)
+enum QueueOp { OP_ENQ, OP_DEQ, NUM_QUEUE_OP };
+const char* const QUEUE_OP_NAMES[NUM_QUEUE_OP] = { "Enq", "Deq" };
+OpLatency<NUM_QUEUE_OP> latencies[32];
+
+void ThreadFunc(int num_thread, int thread_id)
 {
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; i++) {
+		const auto op_begin = LatencyClock::now();
 		if ((rand() % 2 == 0) || (i < (10000 / num_thread))) {
 			my_queue.Enq(i);
+			latency.record(OP_ENQ, op_begin);
 		}
 		else {
 			int key = my_queue.Deq();
+			latency.record(OP_DEQ, op_begin);
 		}
 	}
 }
@@ -130,13 +140,14 @@ int main()
 		vector <thread> threads;
 		auto s = high_resolution_clock::now();
 		for (int i = 0; i < n; ++i)
-			threads.emplace_back(ThreadFunc, n);
+			threads.emplace_back(ThreadFunc, n, i);
 		for (auto& th : threads) th.join();
 		auto d = high_resolution_clock::now() - s;
 		my_queue.display20();
 		//my_queue.recycle_freelist();
 		cout << n << "Threads,  ";
 		cout << ",  Duration : " << duration_cast<milliseconds>(d).count() << " msecs.\n";
+		print_latency(cout, latencies, n, QUEUE_OP_NAMES);
 	}
 	system("pause");
 }
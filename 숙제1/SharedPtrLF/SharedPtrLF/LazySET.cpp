@@ -8,135 +8,40 @@
 #include <chrono>
 #include <memory>
 #include <atomic>
+#include "LazySET.h"
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 
 static constexpr int NUM_TEST = 400000;
 static constexpr int RANGE = 1000;
 
-struct Node {
-public:
-	int key;
-	shared_ptr<Node> next;
-	mutex m_lock;
-	bool deleted{ false };
+using namespace shared_ptr_lf;
 
-	Node() : next{ nullptr } {}
-	Node(int key) : key{ key }, next{ nullptr } {}
-	~Node() {}
-	void lock() { m_lock.lock(); }
-	void unlock() { m_lock.unlock(); }
-};
+ZSet mySet;
 
-class ZSet {
-	shared_ptr<Node> head, tail;
-public:
-	ZSet() : head{ make_shared<Node>(0x80000000) }, tail{ make_shared<Node>(0x7fffffff) } { head->next = tail; }
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[32];
 
-	bool add(int x) {
-		shared_ptr<Node> pred, curr;
-		while (true)
-		{
-			pred = head;
-			curr = atomic_load(&(pred->next));
-
-			while (curr->key < x) {
-				pred = curr;
-				curr = atomic_load(&(curr->next));
-			}
-			{
-				lock_guard<mutex> pl(pred->m_lock);
-				lock_guard<mutex> cl(curr->m_lock);
-				if (validate(pred, curr)) {
-					if (curr->key == x) { return false; }
-					else {
-						auto e = make_shared<Node>(x);
-						e->next = curr;
-
-						// �� �κ��� ������ ���̽��� �״´�.
-						// shared_ptr�� ������ �� ���� �ܰ踦 ��ġ�� ������ ���� ���� �ٸ� thread�� �о ���� ���� �ִ�.
-						atomic_store(&(pred->next), e);
-						return true;
-					}
-				}
-			}
-		}
-	}
-
-	bool remove(int x) {
-		shared_ptr<Node> pred, curr;
-		while (true)
-		{
-			pred = head;
-			curr = atomic_load(&(pred->next));
-
-			while (curr->key < x) {
-				pred = curr;
-				curr = atomic_load(&(curr->next));
-			}
-
-			{
-				lock_guard<mutex> pl(pred->m_lock);
-				lock_guard<mutex> cl(curr->m_lock);
-				if (validate(pred, curr))
-				{
-					if (curr->key != x) { return false; }
-					else {
-						curr->deleted = true;
-						atomic_store(&(pred->next), atomic_load(&(curr->next)));
-						return true;
-					}
-				}
-			}
-		}
-	}
-
-	bool contains(int x) {
-		shared_ptr<Node> pred, curr;
-		while (true)
-		{
-			pred = head;
-			curr = atomic_load(&(pred->next));
-
-			while (curr->key < x) {
-				pred = curr;
-				curr = atomic_load(&(curr->next));
-			}
-			return curr->key == x && !curr->deleted;
-		}
-	}
-
-	void clear() {
-		head->next = tail;
-	}
-
-	bool validate(shared_ptr<Node>& pred, shared_ptr<Node>& curr) {
-		return !pred->deleted && !curr->deleted && atomic_load(&(pred->next)) == curr;
-	}
-
-	void dump(size_t count) {
-		auto& ptr = head->next;
-		cout << count << " Result : ";
-		for (auto i = 0; i < count && ptr != tail; ++i) {
-			cout << ptr->key << " ";
-			ptr = ptr->next;
-		}
-		cout << "\n";
-	}
-} mySet;
-
-void benchMark(int num_thread) {
+void benchMark(int num_thread, int thread_id) {
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; ++i) {
+		const auto op_begin = LatencyClock::now();
 		switch (rand() % 3)
 		{
 		case 0:
 			mySet.add(rand() % RANGE);
+			latency.record(OP_ADD, op_begin);
 			break;
 		case 1:
 			mySet.remove(rand() % RANGE);
+			latency.record(OP_REMOVE, op_begin);
 			break;
 		case 2:
 			mySet.contains(rand() % RANGE);
+			latency.record(OP_CONTAINS, op_begin);
 			break;
 		default:
 			cout << "Error\n";
@@ -153,7 +58,7 @@ int main() {
 		threads.clear();
 
 		auto start_t = chrono::high_resolution_clock::now();
-		generate_n(back_inserter(threads), thread_num, [thread_num]() {return thread{ benchMark, thread_num }; });
+		generate_n(back_inserter(threads), thread_num, [thread_num, thread_id = 0]() mutable {return thread{ benchMark, thread_num, thread_id++ }; });
 		for (auto& t : threads) { t.join(); }
 		auto du = chrono::high_resolution_clock::now() - start_t;
 
@@ -161,5 +66,6 @@ int main() {
 
 		cout << thread_num << "Threads, Time = ";
 		cout << chrono::duration_cast<chrono::milliseconds>(du).count() << "ms \n";
+		print_latency(cout, latencies, thread_num, SET_OP_NAMES);
 	}
 }
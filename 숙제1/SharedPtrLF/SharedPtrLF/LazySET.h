@@ -0,0 +1,124 @@
+#pragma once
+#include <iostream>
+#include <mutex>
+#include <memory>
+#include <atomic>
+
+using namespace std;
+
+// shared_ptr로 node를 관리하는 lazy synchronization list set
+// 다른 과제의 같은 이름 class와 함께 link 될 수 있도록 namespace 안에 둠.
+namespace shared_ptr_lf {
+
+struct Node {
+public:
+	int key;
+	shared_ptr<Node> next;
+	mutex m_lock;
+	bool deleted{ false };
+
+	Node() : next{ nullptr } {}
+	Node(int key) : key{ key }, next{ nullptr } {}
+	~Node() {}
+	void lock() { m_lock.lock(); }
+	void unlock() { m_lock.unlock(); }
+};
+
+class ZSet {
+	shared_ptr<Node> head, tail;
+public:
+	ZSet() : head{ make_shared<Node>(0x80000000) }, tail{ make_shared<Node>(0x7fffffff) } { head->next = tail; }
+
+	bool add(int x) {
+		shared_ptr<Node> pred, curr;
+		while (true)
+		{
+			pred = head;
+			curr = atomic_load(&(pred->next));
+
+			while (curr->key < x) {
+				pred = curr;
+				curr = atomic_load(&(curr->next));
+			}
+			{
+				lock_guard<mutex> pl(pred->m_lock);
+				lock_guard<mutex> cl(curr->m_lock);
+				if (validate(pred, curr)) {
+					if (curr->key == x) { return false; }
+					else {
+						auto e = make_shared<Node>(x);
+						e->next = curr;
+
+						// �� �κ��� ������ ���̽��� �״´�.
+						// shared_ptr�� ������ �� ���� �ܰ踦 ��ġ�� ������ ���� ���� �ٸ� thread�� �о ���� ���� �ִ�.
+						atomic_store(&(pred->next), e);
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	bool remove(int x) {
+		shared_ptr<Node> pred, curr;
+		while (true)
+		{
+			pred = head;
+			curr = atomic_load(&(pred->next));
+
+			while (curr->key < x) {
+				pred = curr;
+				curr = atomic_load(&(curr->next));
+			}
+
+			{
+				lock_guard<mutex> pl(pred->m_lock);
+				lock_guard<mutex> cl(curr->m_lock);
+				if (validate(pred, curr))
+				{
+					if (curr->key != x) { return false; }
+					else {
+						curr->deleted = true;
+						atomic_store(&(pred->next), atomic_load(&(curr->next)));
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	bool contains(int x) {
+		shared_ptr<Node> pred, curr;
+		while (true)
+		{
+			pred = head;
+			curr = atomic_load(&(pred->next));
+
+			while (curr->key < x) {
+				pred = curr;
+				curr = atomic_load(&(curr->next));
+			}
+			return curr->key == x && !curr->deleted;
+		}
+	}
+
+	void clear() {
+		head->next = tail;
+	}
+
+	bool validate(shared_ptr<Node>& pred, shared_ptr<Node>& curr) {
+		return !pred->deleted && !curr->deleted && atomic_load(&(pred->next)) == curr;
+	}
+
+	void dump(size_t count) {
+		auto& ptr = head->next;
+		cout << count << " Result : ";
+		for (size_t i = 0; i < count && ptr != tail; ++i) {
+			cout << ptr->key << " ";
+			ptr = ptr->next;
+		}
+		cout << "\n";
+	}
+};
+
+}
@@ -5,123 +5,34 @@
 #include <mutex>
 #include <vector>
 #include <memory>
+#include "lfqueue.h"
+#include "../../../common/latency_histogram.h"
 
 using namespace std;
 using namespace std::chrono;
 
-class NODE {
-public:
-	int key;
-	shared_ptr<NODE> next;
-
-	NODE() { next = nullptr; }
-	NODE(int key_value) {
-		next = nullptr;
-		key = key_value;
-	}
-	~NODE() {}
-};
-
-
-class LFQUEUE {
-	shared_ptr<NODE> head;
-	shared_ptr<NODE> tail;
-public:
-	LFQUEUE()
-	{
-		head = make_shared<NODE>(0);
-		tail = head;
-	}
-	~LFQUEUE() {}
-
-	void Init()
-	{
-		//NODE* ptr;
-		while (head->next != nullptr) {
-			//ptr = head->next;
-			head->next = head->next->next;
-			//delete ptr;
-		}
-		tail = head;
-	}
-	bool CAS(shared_ptr<NODE>* addr, shared_ptr<NODE>& old_node, shared_ptr<NODE>& new_node)
-	{
-		return atomic_compare_exchange_strong(addr, (&old_node), new_node);
-	}
-	void Enq(int key)
-	{
-		//NODE* e = new NODE(key);
-		shared_ptr<NODE> e = make_shared<NODE>(key);
-
-		while (true) {
-			shared_ptr<NODE> last = atomic_load(&tail);
-			shared_ptr<NODE> next = atomic_load(&last->next);
-			if (last != tail) continue;
-			if (next != nullptr) {
-				CAS(&tail, last, next);
-				continue;
-			}
-			shared_ptr<NODE> null_sp;
-			if (false == CAS(&last->next, null_sp, e)) continue;
-			CAS(&tail, last, e);
-			return;
-		}
-	}
-	int Deq()
-	{
-		while (true) {
-			shared_ptr<NODE> first = atomic_load(&head);
-			shared_ptr<NODE> next = atomic_load(&(first->next));
-			shared_ptr<NODE> last = atomic_load(&tail);
-			shared_ptr<NODE> lastnext = atomic_load(&last->next);
-			if (first != head) continue;
-			if (last == first) {
-				if (lastnext == nullptr) {
-					//cout << "EMPTY!!!\n";
-					//this_thread::sleep_for(1ms);
-					return -1;
-				}
-				else
-				{
-					CAS(&tail, last, lastnext);
-					continue;
-				}
-			}
-			if (nullptr == next) continue;
-			int result = next->key;
-			if (false == CAS(&head, first, next)) continue;
-			first->next = nullptr;
-			//delete first;
-			return result;
-		}
-	}
-
-	void display20()
-	{
-		int c = 20;
-		shared_ptr<NODE> p = head->next;
-		while (p != nullptr)
-		{
-			cout << p->key << ", ";
-			p = p->next;
-			c--;
-			if (c == 0) break;
-		}
-		cout << endl;
-	}
-};
+using namespace shared_ptr_lf;
 
 const auto NUM_TEST = 1000000;
 
 LFQUEUE my_queue;
-void ThreadFunc(int num_thread)
+enum QueueOp { OP_ENQ, OP_DEQ, NUM_QUEUE_OP };
+const char* const QUEUE_OP_NAMES[NUM_QUEUE_OP] = { "Enq", "Deq" };
+OpLatency<NUM_QUEUE_OP> latencies[32];
+
+void ThreadFunc(int num_thread, int thread_id)
 {
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; i++) {
+		const auto op_begin = LatencyClock::now();
 		if ((rand() % 2 == 0) || (i < (10000 / num_thread))) {
 			my_queue.Enq(i);
+			latency.record(OP_ENQ, op_begin);
 		}
 		else {
 			int key = my_queue.Deq();
+			latency.record(OP_DEQ, op_begin);
 		}
 	}
 }
@@ -133,13 +44,14 @@ int main()
 		vector <thread> threads;
 		auto s = high_resolution_clock::now();
 		for (int i = 0; i < n; ++i)
-			threads.emplace_back(ThreadFunc, n);
+			threads.emplace_back(ThreadFunc, n, i);
 		for (auto& th : threads) th.join();
 		auto d = high_resolution_clock::now() - s;
 		my_queue.display20();
 		//my_queue.recycle_freelist();
 		cout << n << "Threads,  ";
 		cout << ",  Duration : " << duration_cast<milliseconds>(d).count() << " msecs.\n";
+		print_latency(cout, latencies, n, QUEUE_OP_NAMES);
 	}
 }
 
@@ -0,0 +1,114 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <atomic>
+
+using namespace std;
+
+// shared_ptr로 node를 관리하는 lock-free queue. (Michael-Scott queue)
+// 다른 과제의 같은 이름 class와 함께 link 될 수 있도록 namespace 안에 둠.
+namespace shared_ptr_lf {
+
+class NODE {
+public:
+	int key;
+	shared_ptr<NODE> next;
+
+	NODE() { next = nullptr; }
+	NODE(int key_value) {
+		next = nullptr;
+		key = key_value;
+	}
+	~NODE() {}
+};
+
+
+class LFQUEUE {
+	shared_ptr<NODE> head;
+	shared_ptr<NODE> tail;
+public:
+	LFQUEUE()
+	{
+		head = make_shared<NODE>(0);
+		tail = head;
+	}
+	~LFQUEUE() {}
+
+	void Init()
+	{
+		//NODE* ptr;
+		while (head->next != nullptr) {
+			//ptr = head->next;
+			head->next = head->next->next;
+			//delete ptr;
+		}
+		tail = head;
+	}
+	bool CAS(shared_ptr<NODE>* addr, shared_ptr<NODE>& old_node, shared_ptr<NODE>& new_node)
+	{
+		return atomic_compare_exchange_strong(addr, (&old_node), new_node);
+	}
+	void Enq(int key)
+	{
+		//NODE* e = new NODE(key);
+		shared_ptr<NODE> e = make_shared<NODE>(key);
+
+		while (true) {
+			shared_ptr<NODE> last = atomic_load(&tail);
+			shared_ptr<NODE> next = atomic_load(&last->next);
+			if (last != tail) continue;
+			if (next != nullptr) {
+				CAS(&tail, last, next);
+				continue;
+			}
+			shared_ptr<NODE> null_sp;
+			if (false == CAS(&last->next, null_sp, e)) continue;
+			CAS(&tail, last, e);
+			return;
+		}
+	}
+	int Deq()
+	{
+		while (true) {
+			shared_ptr<NODE> first = atomic_load(&head);
+			shared_ptr<NODE> next = atomic_load(&(first->next));
+			shared_ptr<NODE> last = atomic_load(&tail);
+			shared_ptr<NODE> lastnext = atomic_load(&last->next);
+			if (first != head) continue;
+			if (last == first) {
+				if (lastnext == nullptr) {
+					//cout << "EMPTY!!!\n";
+					//this_thread::sleep_for(1ms);
+					return -1;
+				}
+				else
+				{
+					CAS(&tail, last, lastnext);
+					continue;
+				}
+			}
+			if (nullptr == next) continue;
+			int result = next->key;
+			if (false == CAS(&head, first, next)) continue;
+			first->next = nullptr;
+			//delete first;
+			return result;
+		}
+	}
+
+	void display20()
+	{
+		int c = 20;
+		shared_ptr<NODE> p = head->next;
+		while (p != nullptr)
+		{
+			cout << p->key << ", ";
+			p = p->next;
+			c--;
+			if (c == 0) break;
+		}
+		cout << endl;
+	}
+};
+
+}
@@ -5,31 +5,49 @@
 #include <vector>
 #include "util.h"
 #include "skiplist.h"
+#include "latency_histogram.h"
+#include "topology.h"
 
 constexpr unsigned MAX_THREAD = 64;
 constexpr unsigned NUM_TEST = 4'000'000;
 
 using namespace std;
 
-void benchMark(HTMSkiplist &skiplist, int num_thread) {
+enum SkiplistOp { OP_INSERT, OP_REMOVE, OP_FIND, NUM_SKIPLIST_OP };
+const char *const SKIPLIST_OP_NAMES[NUM_SKIPLIST_OP] = {"insert", "remove",
+                                                        "find  "};
+OpLatency<NUM_SKIPLIST_OP> latencies[MAX_THREAD];
+ThreadPlacement placements[MAX_THREAD];
+
+void benchMark(HTMSkiplist &skiplist, const vector<int> &cpus, int num_thread,
+               int thread_id) {
+    pin_thread(cpus, thread_id);
+    auto &latency = latencies[thread_id];
+    latency.reset();
     for (int i = 1; i <= NUM_TEST / num_thread; ++i) {
+        const auto op_begin = LatencyClock::now();
         switch (fast_rand() % 3) {
         case 0:
             skiplist.insert(fast_rand() % 1000, fast_rand());
+            latency.record(OP_INSERT, op_begin);
             break;
         case 1:
             skiplist.remove(fast_rand() % 1000);
+            latency.record(OP_REMOVE, op_begin);
             break;
         default:
             skiplist.find(fast_rand() % 1000);
+            latency.record(OP_FIND, op_begin);
             break;
         }
     }
+    placements[thread_id] = ThreadPlacement::current();
 }
 
 int main(int argc, char *argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "you have to give a thread num\n");
+        fprintf(stderr, "you have to give a thread num [and a pin policy: "
+                        "none|compact|scatter|smt (default compact)]\n");
         exit(-1);
     }
     unsigned num_thread = atoi(argv[1]);
@@ -39,17 +57,29 @@ int main(int argc, char *argv[]) {
         exit(-1);
     }
 
+    auto pin = PinPolicy::Compact;
+    if (argc >= 3 && !parse_pin_policy(argv[2], pin)) {
+        fprintf(stderr, "unknown pin policy: %s\n", argv[2]);
+        exit(-1);
+    }
+    const auto cpus = CpuTopology::get().order(pin);
+
     HTMSkiplist skiplist;
 
     vector<thread> worker;
     auto start_t = chrono::high_resolution_clock::now();
     for (int i = 0; i < num_thread; ++i)
-        worker.emplace_back(benchMark, ref(skiplist), num_thread);
+        worker.emplace_back(benchMark, ref(skiplist), cref(cpus), num_thread,
+                            i);
     for (auto &th : worker)
         th.join();
     auto du = chrono::high_resolution_clock::now() - start_t;
 
-    cout << num_thread << " Threads,  Time = ";
+    CpuTopology::get().describe(cout);
+    cout << num_thread << " Threads,  Pin = " << to_string(pin)
+         << ",  Time = ";
     cout << chrono::duration_cast<chrono::milliseconds>(du).count() << " ms"
          << endl;
+    print_latency(cout, latencies, num_thread, SKIPLIST_OP_NAMES);
+    print_placement(cout, placements, placements + num_thread);
 }
@@ -44,7 +44,8 @@ unique_lock<mutex> try_to_start_tx(mutex &lock, bool &is_force_aborted) {
 }
 
 bool HTMSkiplist::insert(long key, long value) {
-    SKNode *node = new SKNode{key, value};
+    auto height = SKNode::random_height();
+    SKNode *node = new (height) SKNode{key, value, height};
     for (int i = 0; i < MAX_TRY; ++i) {
         switch (this->insert_htm(*node)) {
         case Success:
@@ -6,6 +6,7 @@
 #include <atomic>
 #include <climits>
 #include <mutex>
+#include <new>
 #include <optional>
 
 using std::optional;
@@ -14,24 +15,40 @@ enum SKNodeState { INITIAL, INSERTED, REMOVED };
 
 constexpr unsigned MAX_HEIGHT = 10;
 
+// next는 실제 높이만큼만 할당한다. 32 byte 단위로 배치하므로 key와 next[0]은 항상 같은 cache line에 있음.
+// operator new에 높이를 넘겨서 만들어야 하며 (new (height) SKNode{...}) delete는 그대로 쓰면 된다.
 struct SKNode {
+    static constexpr std::align_val_t ALIGN{32};
+
     long key, value;
     unsigned height;
     volatile SKNodeState state;
-    volatile SKNode *next[MAX_HEIGHT];
+    volatile SKNode *next[];
+
+    SKNode(long key, long value, unsigned height)
+        : key{key}, value{value}, height{height}, state{INITIAL} {
+        for (unsigned i = 0; i < height; ++i)
+            next[i] = nullptr;
+    }
 
-    SKNode(long key, long value) : SKNode{key, value, 1} {
-        for (int i = 0; i < MAX_HEIGHT - 1; ++i) {
+    static unsigned random_height() {
+        unsigned height = 1;
+        for (unsigned i = 0; i < MAX_HEIGHT - 1; ++i) {
             if (fast_rand() % 100 < 50)
                 height++;
             else
                 break;
         }
+        return height;
     }
-    SKNode(long key, long value, unsigned height)
-        : next{}, state{INITIAL}, height{height}, key{key}, value{value} {
-        for (auto i = 0; i < MAX_HEIGHT; ++i)
-            next[i] = nullptr;
+
+    static void *operator new(size_t size, unsigned height) {
+        return ::operator new(size + height * sizeof(SKNode *), ALIGN);
+    }
+    static void operator delete(void *ptr) { ::operator delete(ptr, ALIGN); }
+    // 생성자에서 예외가 나면 불림
+    static void operator delete(void *ptr, unsigned) {
+        ::operator delete(ptr, ALIGN);
     }
 };
 
@@ -40,9 +57,9 @@ enum HTMResult { Success, Fail, HTMAbort };
 class HTMSkiplist {
   public:
     HTMSkiplist()
-        : head{new SKNode{LONG_MIN, LONG_MIN, MAX_HEIGHT}},
-          tail{new SKNode{LONG_MAX, LONG_MAX, MAX_HEIGHT}} {
-        for (auto i = 0; i < MAX_HEIGHT; ++i)
+        : head{new (MAX_HEIGHT) SKNode{LONG_MIN, LONG_MIN, MAX_HEIGHT}},
+          tail{new (MAX_HEIGHT) SKNode{LONG_MAX, LONG_MAX, MAX_HEIGHT}} {
+        for (unsigned i = 0; i < MAX_HEIGHT; ++i)
             head->next[i] = tail;
     }
     ~HTMSkiplist() {
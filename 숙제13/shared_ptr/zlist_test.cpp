@@ -5,6 +5,7 @@
 #include <mutex>
 #include <vector>
 #include "htm_shared_ptr.h"
+#include "../../common/latency_histogram.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -126,6 +127,7 @@ public:
 				continue;
 			}
 			if (key == curr->key) {
+				curr->removed = true;
 				pred->next = curr->next;
 				fl_mutex.lock();
 				curr->next = freelist;
@@ -289,6 +291,7 @@ public:
 				continue;
 			}
 			if (key == curr->key) {
+				curr->removed = true;
 				pred->next = curr->next;
 				pred->unlock();
 				curr->unlock();
@@ -336,19 +339,29 @@ atomic_uint abort_explicit{0};
 atomic_uint abort_other{0};
 atomic_uint tx_success{0};
 
-void ThreadFunc(int num_thread)
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[16];
+
+void ThreadFunc(int num_thread, int thread_id)
 {
 	int key = 0;
+	auto& latency = latencies[thread_id];
+	latency.reset();
 	for (int i = 0; i < NUM_TEST / num_thread; i++) {
+		const auto op_begin = LatencyClock::now();
 		switch (rand() % 3) {
 		case 0: key = rand() % KEY_RANGE;
 			list.Add(key);
+			latency.record(OP_ADD, op_begin);
 			break;
 		case 1: key = rand() % KEY_RANGE;
 			list.Remove(key);
+			latency.record(OP_REMOVE, op_begin);
 			break;
 		case 2: key = rand() % KEY_RANGE;
 			list.Contains(key);
+			latency.record(OP_CONTAINS, op_begin);
 			break;
 		default: cout << "Error\n";
 			exit(-1);
@@ -374,13 +387,14 @@ int main()
 		vector <thread> threads;
 		auto s = high_resolution_clock::now();
 		for (int i = 0; i < n; ++i)
-			threads.emplace_back(ThreadFunc, n);
+			threads.emplace_back(ThreadFunc, n, i);
 		for (auto& th : threads) th.join();
 		auto d = high_resolution_clock::now() - s;
 		list.display20();
 		//list.recycle_freelist();
 		cout << n << "Threads,  ";
 		cout << ",  Duration : " << duration_cast<milliseconds>(d).count() << " msecs.\n";
+		print_latency(cout, latencies, n, SET_OP_NAMES);
 
         cerr << "total abort: " << abort_capacity.load() + abort_conflict.load() + abort_explicit.load() + abort_other.load() << endl;
         cerr << "    capacity: " << abort_capacity << endl;
@@ -4,75 +4,124 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "../../../common/key_space.h"
+#include "../../../common/latency_histogram.h"
+#ifdef __linux__
+#include "../../../common/topology.h"
+#endif
 
 using namespace std;
 using namespace std::chrono;
 
 constexpr int MAXHEIGHT = 10;
+
+// rand()는 glibc에서 전역 lock을 잡아서 thread가 많아지면 replica들의 Add가 모두 직렬화된다.
+// 높이를 정하는 난수는 thread마다 따로 상태를 가지는 xorshift64*로 만든다.
+inline uint64_t fast_rand()
+{
+	static thread_local uint64_t state = 0x9E3779B97F4A7C15ull;
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545F4914F6CDD1Dull;
+}
+// next는 실제 높이만큼만 할당하는 가변 길이 tower. key와 next[0]이 node의 앞쪽 16 byte 안에 모이도록 height를 key 옆에 둔다.
+// new (height) SLNODE(key, height)로 만들고 delete는 그대로 쓰면 됨.
 class SLNODE {
 public:
 	int key;
-	SLNODE* next[MAXHEIGHT];
 	int height;
+	SLNODE* next[];
 	SLNODE(int x, int h)
 	{
 		key = x;
 		height = h;
-		for (auto& p : next) p = nullptr;
-	}
-	SLNODE(int x)
-	{
-		key = x;
-		height = MAXHEIGHT;
-		for (auto& p : next) p = nullptr;
+		for (int i = 0; i < h; ++i) next[i] = nullptr;
 	}
-	SLNODE()
+	static void* operator new(size_t size, int height)
 	{
-		key = 0;
-		height = MAXHEIGHT;
-		for (auto& p : next) p = nullptr;
+		return ::operator new(size + height * sizeof(SLNODE*));
 	}
+	static void operator delete(void* p) { ::operator delete(p); }
+	// 생성자에서 예외가 나면 불림
+	static void operator delete(void* p, int) { ::operator delete(p); }
 };
 
 class SKLIST {
-	SLNODE head, tail;
+	SLNODE* head, * tail;
+	// 마지막으로 찾은 key와 그때의 preds (finger). 다음 key가 그보다 크거나 같으면 head 대신 finger에서 시작한다.
+	// Object는 thread마다 하나씩이므로 각 thread의 검색 hint가 됨.
+	SLNODE* finger[MAXHEIGHT];
+	int finger_key;
 public:
 	SKLIST()
 	{
-		head.key = 0x80000000;
-		tail.key = 0x7FFFFFFF;
-		head.height = tail.height = MAXHEIGHT;
-		for (auto& p : head.next) p = &tail;
+		head = new (MAXHEIGHT) SLNODE(INT_MIN, MAXHEIGHT);
+		tail = new (MAXHEIGHT) SLNODE(INT_MAX, MAXHEIGHT);
+		for (int i = 0; i < MAXHEIGHT; ++i) head->next[i] = tail;
+		ResetFinger();
+	}
+	SKLIST(const SKLIST&) = delete;
+	// objects.resize()에 필요. 옮겨진 쪽은 head가 nullptr이 되어 아무것도 해제하지 않음
+	SKLIST(SKLIST&& other) noexcept : head{ other.head }, tail{ other.tail }, finger_key{ other.finger_key }
+	{
+		for (int i = 0; i < MAXHEIGHT; ++i) finger[i] = other.finger[i];
+		other.head = other.tail = nullptr;
 	}
 	~SKLIST() {
+		if (head == nullptr) return;
 		Init();
+		delete head;
+		delete tail;
 	}
 
 	void Init()
 	{
 		SLNODE* ptr;
-		while (head.next[0] != &tail) {
-			ptr = head.next[0];
-			head.next[0] = head.next[0]->next[0];
+		while (head->next[0] != tail) {
+			ptr = head->next[0];
+			head->next[0] = head->next[0]->next[0];
 			delete ptr;
 		}
-		for (auto& p : head.next) p = &tail;
+		for (int i = 0; i < MAXHEIGHT; ++i) head->next[i] = tail;
+		ResetFinger();
 	}
+	void ResetFinger()
+	{
+		for (auto& p : finger) p = head;
+		finger_key = head->key;
+	}
+	// finger search. key가 직전에 찾은 key보다 작으면 head에서 다시 시작한다.
+	// finger의 다음 node가 key보다 작지 않은 가장 낮은 level까지만 올라가서 거기서부터 내려오므로
+	// 가까운 key를 연달아 찾으면 O(log n) 대신 key 거리 d에 대해 O(log d)만 걷는다.
 	void Find(int key, SLNODE* preds[MAXHEIGHT], SLNODE* currs[MAXHEIGHT])
 	{
-		int cl = MAXHEIGHT - 1;
-		while (true) {
-			if (MAXHEIGHT - 1 == cl)
-				preds[cl] = &head;
+		if (key < finger_key) ResetFinger();
+		int top = 0;
+		while (top < MAXHEIGHT - 1 && finger[top]->next[top]->key < key) top++;
+		// top 위의 level은 finger가 그대로 답
+		for (int cl = MAXHEIGHT - 1; cl > top; --cl) {
+			preds[cl] = finger[cl];
+			currs[cl] = finger[cl]->next[cl];
+		}
+		for (int cl = top; cl >= 0; --cl) {
+			// finger와 위 level에서 내려온 pred 중 더 가까운 쪽에서 시작
+			if (cl == top || preds[cl + 1]->key < finger[cl]->key)
+				preds[cl] = finger[cl];
 			else preds[cl] = preds[cl + 1];
 			currs[cl] = preds[cl]->next[cl];
 			while (currs[cl]->key < key) {
 				preds[cl] = currs[cl];
 				currs[cl] = currs[cl]->next[cl];
 			}
-			if (0 == cl) return;
-			cl--;
 		}
+		for (int cl = 0; cl < MAXHEIGHT; ++cl) finger[cl] = preds[cl];
+		finger_key = key;
 	}
 
 	bool Add(int key)
@@ -86,11 +135,11 @@ public:
 		}
 		else {
 			int height = 1;
-			while (rand() % 2 == 0) {
+			while (fast_rand() % 2 == 0) {
 				height++;
 				if (MAXHEIGHT == height) break;
 			}
-			SLNODE* node = new SLNODE(key, height);
+			SLNODE* node = new (height) SLNODE(key, height);
 			for (int i = 0; i < height; ++i) {
 				preds[i]->next[i] = node;
 				node->next[i] = currs[i];
@@ -131,8 +180,8 @@ public:
 	void display20()
 	{
 		int c = 20;
-		SLNODE* p = head.next[0];
-		while (p != &tail)
+		SLNODE* p = head->next[0];
+		while (p != tail)
 		{
 			cout << p->key << ", ";
 			p = p->next[0];
@@ -201,9 +250,14 @@ struct Object {
 
 constexpr int RECYCLE_RATE = 100;
 
+// Node::max(head)로 다른 thread의 head를 읽는 동안 홀수가 되는 thread별 counter
+struct alignas(64) ScanCount {
+	atomic_uint count{ 0 };
+};
+
 class OLFUniversal {
 public:
-	OLFUniversal(int capacity) : capacity{ capacity }, invoke_num{ 0 } {
+	OLFUniversal(int capacity) : scanning(capacity), capacity{ capacity }, invoke_num{ 0 } {
 		Invoc invoc{ Func::None };
 		tail = new Node(move(invoc));
 		tail->seq = 1;
@@ -243,7 +297,7 @@ public:
 
 		Node* prefer = new Node(move(invoc));
 		while (prefer->seq == 0) {
-			Node* before = Node::max(head);
+			Node* before = max_head(thread_id);
 			Node* after = nullptr;
 			if (before->decide_next.compare_exchange_strong(after, prefer))
 				after = prefer;
@@ -273,7 +327,7 @@ public:
 	}
 
 	Response do_read_only(Invoc&& invoc, int thread_id) {
-		auto old_head = Node::max(head);
+		auto old_head = max_head(thread_id);
 		auto& last_node = last_nodes[thread_id];
 		auto& last_obj = objects[thread_id];
 
@@ -292,14 +346,24 @@ public:
 		return last_obj.apply(invoc);
 	}
 
+	// 다른 thread의 head는 읽은 직후 더 앞으로 나가서 recycle에 지워질 수 있으므로 읽는 동안을 scanning에 알린다.
+	// 돌려주는 node는 자기 head보다 뒤에 있으므로 scan이 끝난 뒤에는 지워지지 않음
+	Node* max_head(int thread_id) {
+		auto& count = scanning[thread_id].count;
+		count.fetch_add(1);
+		Node* m = Node::max(head);
+		count.fetch_add(1, memory_order_release);
+		return m;
+	}
+
 	void recycle() {
 		Node* min = last_nodes[0];
-		for (auto i = 1; i < last_nodes.size(); ++i) {
+		for (size_t i = 1; i < last_nodes.size(); ++i) {
 			if (last_nodes[i]->seq < min->seq) {
 				min = last_nodes[i];
 			}
 		}
-		for (auto i = 0; i < head.size(); ++i) {
+		for (size_t i = 0; i < head.size(); ++i) {
 			if (head[i]->seq < min->seq) {
 				min = head[i];
 			}
@@ -308,7 +372,13 @@ public:
 		if (min == tail) { return; }
 
 		auto old_next = tail->next.load(memory_order_relaxed);
-		tail->next.store(min, memory_order_relaxed);
+		tail->next.store(min);
+		// 떼어낸 node를 읽고 있었을 수도 있는 thread들이 scan을 끝낼 때까지 기다림
+		for (auto& s : scanning) {
+			const auto c = s.count.load();
+			if (c % 2 == 0) continue;
+			while (s.count.load(memory_order_acquire) == c) this_thread::yield();
+		}
 		while (old_next != min) {
 			auto tmp = old_next;
 			old_next = old_next->next.load(memory_order_relaxed);
@@ -318,49 +388,195 @@ public:
 private:
 	vector<Node*> head;
 	vector<Node*> last_nodes;
+	vector<ScanCount> scanning;
 	vector<Object> objects;
 	Node* tail;
 	int capacity;
 	atomic_ullong invoke_num;
 };
 
-const auto NUM_TEST = 4000000;
-const auto KEY_RANGE = 1000;
-void ThreadFunc(OLFUniversal* list, int num_thread, int thread_id)
-{
-	int key;
+// IPP_HW5와 같은 조건으로 비교할 수 있도록 기본값과 인자 이름을 맞춤
+struct Workload : KeySpace {
+	// 연산 비율 (%). 합은 100
+	int read = 30;
+	int add = 35;
+	int remove = 35;
+	long long num_ops = 4000000;
+	vector<int> threads;
+#ifdef __linux__
+	PinPolicy pin = PinPolicy::Compact;
+#endif
+};
 
-	for (int i = 0; i < NUM_TEST / num_thread; i++) {
-		switch (rand() % 3) {
-		case 0: key = rand() % KEY_RANGE;
+constexpr int MAX_THREAD = 64;
+
+enum SetOp { OP_ADD, OP_REMOVE, OP_CONTAINS, NUM_SET_OP };
+const char* const SET_OP_NAMES[NUM_SET_OP] = { "Add     ", "Remove  ", "Contains" };
+OpLatency<NUM_SET_OP> latencies[MAX_THREAD];
+#ifdef __linux__
+ThreadPlacement placements[MAX_THREAD];
+#endif
+
+void ThreadFunc(OLFUniversal* list, const Workload* workload, const vector<int>* cpus, int num_thread, int thread_id)
+{
+#ifdef __linux__
+	pin_thread(*cpus, thread_id);
+#endif
+	KeyGenerator gen{ *workload, thread_id };
+	auto& latency = latencies[thread_id];
+	latency.reset();
+
+	for (long long i = 0; i < workload->num_ops / num_thread; i++) {
+		const auto ticket = static_cast<int>(gen.next_rand() % 100);
+		const auto key = gen.next_key();
+		const auto op_begin = LatencyClock::now();
+		if (ticket < workload->read) {
+			list->apply(Invoc(Func::Contains, key), thread_id);
+			latency.record(OP_CONTAINS, op_begin);
+		}
+		else if (ticket < workload->read + workload->add) {
 			list->apply(Invoc(Func::Add, key), thread_id);
-			break;
-		case 1: key = rand() % KEY_RANGE;
+			latency.record(OP_ADD, op_begin);
+		}
+		else {
 			list->apply(Invoc(Func::Remove, key), thread_id);
-			break;
-		case 2: key = rand() % KEY_RANGE;
-			list->apply(Invoc(Func::Contains, key), thread_id);
-			break;
-		default: cout << "Error\n";
-			exit(-1);
+			latency.record(OP_REMOVE, op_begin);
 		}
 	}
+#ifdef __linux__
+	placements[thread_id] = ThreadPlacement::current();
+#endif
+}
+
+void print_usage(const char* prog)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --read=P                 P%% contains, the rest split between add/remove\n"
+		"  --mix=R:A:D              contains:add:remove percentages\n"
+		"  --keys=N                 key range (default 1000)\n"
+		"  --dist=uniform|zipf|hotspot\n"
+		"  --zipf=THETA             zipf skew (default 0.99)\n"
+		"  --hot=K:O                hotspot: K%% of keys get O%% of operations (default 20:80)\n"
+		"  --ops=N                  total operations per run (default 4000000)\n"
+		"  --threads=1,2,4          thread counts (default 1,2,4,8,16)\n"
+#ifdef __linux__
+		"  --pin=none|compact|scatter|smt  thread placement (default compact)\n"
+#endif
+		, prog);
 }
 
-int main() {
-	for (auto n = 1; n <= 16; n *= 2) {
+// 잘못된 인자가 있으면 사용법을 출력하고 종료한다.
+Workload parse_workload(int argc, char* argv[])
+{
+	Workload workload;
+	auto fail = [argv](const string& arg) {
+		fprintf(stderr, "invalid argument: %s\n", arg.c_str());
+		print_usage(argv[0]);
+		exit(-1);
+	};
+
+	for (auto i = 1; i < argc; ++i) {
+		const string arg = argv[i];
+		if (arg == "-h" || arg == "--help") {
+			print_usage(argv[0]);
+			exit(0);
+		}
+		const auto eq = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || eq == string::npos)
+			fail(arg);
+		const auto name = arg.substr(2, eq - 2);
+		const auto value = arg.substr(eq + 1);
+		bool ok;
+
+		if (name == "read") {
+			workload.read = atoi(value.c_str());
+			workload.add = (100 - workload.read) / 2;
+			workload.remove = 100 - workload.read - workload.add;
+		}
+		else if (name == "mix") {
+			const auto tokens = split(value, ':');
+			if (tokens.size() != 3)
+				fail(arg);
+			workload.read = atoi(tokens[0].c_str());
+			workload.add = atoi(tokens[1].c_str());
+			workload.remove = atoi(tokens[2].c_str());
+		}
+		else if (parse_key_option(name, value, workload, ok)) {
+			if (!ok)
+				fail(arg);
+		}
+		else if (name == "ops")
+			workload.num_ops = atoll(value.c_str());
+		else if (name == "threads") {
+			for (auto& token : split(value, ','))
+				workload.threads.push_back(atoi(token.c_str()));
+		}
+#ifdef __linux__
+		else if (name == "pin") {
+			if (!parse_pin_policy(value, workload.pin))
+				fail(arg);
+		}
+#endif
+		else
+			fail(arg);
+	}
+
+	if (workload.threads.empty()) {
+		for (auto n = 1; n <= 16; n *= 2)
+			workload.threads.push_back(n);
+	}
+	for (auto n : workload.threads) {
+		if (n < 1 || MAX_THREAD < n)
+			fail("--threads");
+	}
+	if (workload.read < 0 || workload.add < 0 || workload.remove < 0 || workload.read + workload.add + workload.remove != 100)
+		fail("--mix");
+	if (!workload.prepare())
+		fail("--keys/--dist/--zipf/--hot");
+	return workload;
+}
+
+// 출력 형식은 IPP_HW5의 text 출력과 같다. replica는 thread마다 하나씩이므로 Replicas는 항상 thread 수
+int main(int argc, char* argv[]) {
+	const auto workload = parse_workload(argc, argv);
+	vector<int> cpus;
+#ifdef __linux__
+	cpus = CpuTopology::get().order(workload.pin);
+	CpuTopology::get().describe(cout);
+	cout << "Pin : " << to_string(workload.pin) << endl;
+#endif
+
+	for (auto n : workload.threads) {
 		OLFUniversal list(n);
 
 		vector <thread> threads;
 		auto s = high_resolution_clock::now();
 		for (int i = 0; i < n; ++i)
-			threads.emplace_back(ThreadFunc, &list, n, i);
+			threads.emplace_back(ThreadFunc, &list, &workload, &cpus, n, i);
 		for (auto& th : threads) th.join();
 		auto d = high_resolution_clock::now() - s;
 
+		OpLatency<NUM_SET_OP> merged;
+		for (auto i = 0; i < n; ++i)
+			merged.merge(latencies[i]);
+		const auto total = merged.total();
+
 		list.current_obj().container.display20();
-		cout << n << "Threads,  ";
-		cout << ",  Duration : " << duration_cast<milliseconds>(d).count() << " msecs." << endl;
+		cout << n << "Threads";
+		cout << ",  Duration : " << duration_cast<milliseconds>(d).count() << " msecs";
+		cout << ",  Replicas : " << n;
+		cout << ",  p50 : " << total.percentile(0.5) << " ns";
+		cout << ",  p99 : " << total.percentile(0.99) << " ns";
+		cout << ",  p99.9 : " << total.percentile(0.999) << " ns";
+		cout << ",  max : " << total.max() << " ns." << endl;
+		for (size_t op = 0; op < NUM_SET_OP; ++op)
+			print_latency_line(cout, SET_OP_NAMES[op], merged[op]);
+#ifdef __linux__
+		print_placement(cout, placements, placements + n);
+#endif
 	}
+#ifdef _WIN32
 	system("pause");
-}
\ No newline at end of file
+#endif
+}
@@ -0,0 +1,135 @@
+#ifndef E52B7D19_0A64_4C3F_B8D1_93E7A4F6C028
+#define E52B7D19_0A64_4C3F_B8D1_93E7A4F6C028
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 한 thread(혹은 한 replica)만 사용하는, 높이마다 크기가 다른 객체(skiplist node)용 slab allocator.
+// T는 static bytes_for(height)로 높이 height인 객체의 byte 수를 알려줘야 한다.
+// 높이마다 따로 CHUNK_BYTES 크기의 chunk를 잡아 bump pointer로 나눠주고, 해제된 객체는 높이별 free list로 재사용한다.
+// 어떤 자리에는 처음 정해진 높이의 객체만 들어가고 할당받은 메모리는 소멸될 때까지 돌려주지 않으므로,
+// lock 없이 읽는 reader가 해제되거나 재사용된 객체를 따라가도 항상 같은 높이(같은 크기와 배치)의 객체를 보게 된다.
+template <typename T, int MAX_HEIGHT, size_t ALIGN = 16, size_t CHUNK_BYTES = 4096>
+class TowerArena
+{
+	static_assert(std::is_trivially_destructible_v<T>, "reset() drops objects without running destructors");
+	static_assert(ALIGN % alignof(T) == 0 && ALIGN >= sizeof(void *), "slots must be able to hold the free list link");
+
+	// 높이 하나에 해당하는 size class
+	struct SizeClass
+	{
+		std::vector<unsigned char *> chunks;
+		size_t cur_chunk = 0;
+		size_t cur_index = 0;
+		unsigned char *free_list = nullptr;
+	};
+
+public:
+	// 높이 height인 객체 하나가 차지하는 자리. ALIGN 단위로 올려서 객체의 앞부분이 cache line 경계에 걸치지 않게 함
+	static constexpr size_t slot_bytes(int height)
+	{
+		return (T::bytes_for(height) + ALIGN - 1) / ALIGN * ALIGN;
+	}
+	static constexpr size_t slots_per_chunk(int height)
+	{
+		return std::max<size_t>(1, CHUNK_BYTES / slot_bytes(height));
+	}
+
+	TowerArena() = default;
+	TowerArena(const TowerArena &) = delete;
+	TowerArena &operator=(const TowerArena &) = delete;
+	TowerArena(TowerArena &&other) noexcept
+	{
+		std::swap(classes, other.classes);
+	}
+	TowerArena &operator=(TowerArena &&other) noexcept
+	{
+		std::swap(classes, other.classes);
+		return *this;
+	}
+	~TowerArena()
+	{
+		for (auto &cls : classes)
+		{
+			for (auto chunk : cls.chunks)
+				::operator delete(chunk, std::align_val_t{ALIGN});
+		}
+	}
+
+	template <typename... Args>
+	T *alloc(int height, Args &&... args)
+	{
+		auto &cls = classes[height - 1];
+		unsigned char *slot;
+		if (cls.free_list != nullptr)
+		{
+			slot = cls.free_list;
+			cls.free_list = link_of(slot, height);
+		}
+		else
+		{
+			if (cls.cur_index == slots_per_chunk(height))
+			{
+				++cls.cur_chunk;
+				cls.cur_index = 0;
+			}
+			if (cls.cur_chunk == cls.chunks.size())
+				cls.chunks.push_back(static_cast<unsigned char *>(::operator new(slots_per_chunk(height) * slot_bytes(height), std::align_val_t{ALIGN})));
+			slot = cls.chunks[cls.cur_chunk] + cls.cur_index++ * slot_bytes(height);
+		}
+		return new (slot) T(std::forward<Args>(args)...);
+	}
+
+	// free list의 link는 자리의 마지막 word에 둔다. 앞부분(key, height)은 그대로 남으므로
+	// 해제된 객체를 읽는 reader는 마지막 word 대신 같은 높이의 다른 자리를 가리키는 pointer(혹은 nullptr)를 보게 됨.
+	void free(T *ptr, int height)
+	{
+		auto slot = reinterpret_cast<unsigned char *>(ptr);
+		auto &cls = classes[height - 1];
+		link_of(slot, height) = cls.free_list;
+		cls.free_list = slot;
+	}
+
+	// 모든 객체를 한 번에 해제. chunk는 그대로 두고 높이마다 처음부터 다시 나눠줌.
+	void reset()
+	{
+		for (auto &cls : classes)
+		{
+			cls.cur_chunk = 0;
+			cls.cur_index = 0;
+			cls.free_list = nullptr;
+		}
+	}
+
+	// 지금까지 확보한 객체 자리 수 (모든 높이의 합)
+	size_t capacity() const
+	{
+		size_t slots = 0;
+		for (auto height = 1; height <= MAX_HEIGHT; ++height)
+			slots += classes[height - 1].chunks.size() * slots_per_chunk(height);
+		return slots;
+	}
+
+	// 지금까지 확보한 chunk의 byte 수
+	size_t reserved_bytes() const
+	{
+		size_t bytes = 0;
+		for (auto height = 1; height <= MAX_HEIGHT; ++height)
+			bytes += classes[height - 1].chunks.size() * slots_per_chunk(height) * slot_bytes(height);
+		return bytes;
+	}
+
+private:
+	static unsigned char *&link_of(unsigned char *slot, int height)
+	{
+		return *reinterpret_cast<unsigned char **>(slot + slot_bytes(height) - sizeof(unsigned char *));
+	}
+
+	std::vector<SizeClass> classes = std::vector<SizeClass>(MAX_HEIGHT);
+};
+
+#endif /* E52B7D19_0A64_4C3F_B8D1_93E7A4F6C028 */
@@ -2,31 +2,28 @@
 proportions=(30 50 70 90)
 
 project_dir=${1:?"give a project's root dir"}
+# 나머지 인자는 그대로 IPP_HW5에 넘김 (예: --log=compact --dist=zipf)
+shift
+extra_args=("$@")
 
 mkdir -p "${project_dir}/bench"
 
+# 측정 조건은 모두 실행 인자로 바뀌므로 한 번만 build
+cmake -D CMAKE_BUILD_TYPE=Release .
+make
+
 for p in ${proportions[@]}
 do
-    cmake -D READ_PROPORTION=${p} -D CMAKE_BUILD_TYPE=Release .
-    make
-
     out_file="${project_dir}/bench/output_read${p}.log"
-    mem_out_file="${project_dir}/bench/mem_read${p}.log"
+    mem_out_file="${project_dir}/bench/mem_read${p}.csv"
 
     echo "Read Proportion: ${p}%" > "${out_file}"
-    echo "Read Proportion: ${p}%" > "${mem_out_file}"
+    # peak/현재 RSS와 할당 횟수는 IPP_HW5가 직접 출력하고, 시간에 따른 RSS는 CSV로 남김
+    rm -f "${mem_out_file}"
     for i in {1..5}
     do
         echo "Iteration $i" >> "${out_file}"
-        echo "Iteration $i" >> "${mem_out_file}"
-
-        bash -c 'while true; do ps -eo rsz,cmd | grep IPP_HW5 | grep -v grep; sleep 1s; done' >> "${mem_out_file}" &
-        pid=$!
-        trap "kill -9 ${pid}" EXIT
-        stdbuf -o 0 "${project_dir}/bin/IPP_HW5" | tee -a "${out_file}"
-        kill -9 ${pid}
-
+        stdbuf -o 0 "${project_dir}/bin/IPP_HW5" --read=${p} --rss-log="${mem_out_file}" "${extra_args[@]}" | tee -a "${out_file}"
         echo "" >> "${out_file}"
-        echo "" >> "${mem_out_file}"
     done
 done
@@ -1,632 +1,287 @@
 #include <vector>
-#include <atomic>
-#include <utility>
 #include <iostream>
 #include <thread>
 #include <chrono>
-#include <mutex>
-#include <shared_mutex>
+#include <string>
+#include <atomic>
+#include <memory>
 #include <optional>
-#include <algorithm>
-#include <cassert>
-#include <unordered_map>
-
-#ifndef READ_PROPORTION
-#define READ_PROPORTION 30
-#endif
+#include "skiplist.h"
+#include "olf_universal.h"
+#include "latency_histogram.h"
+#include "workload.h"
+#include "memory_monitor.h"
+#include "history.h"
 
 using namespace std;
 using namespace std::chrono;
 
-unsigned long fast_rand(void)
-{ //period 2^96-1
-	static thread_local unsigned long x = 123456789, y = 362436069, z = 521288629;
-	unsigned long t;
-	x ^= x << 16;
-	x ^= x >> 5;
-	x ^= x << 1;
+using SkiplistUC = OLFUniversal<SkiplistObject, Invoc, Response>;
 
-	t = x;
-	x = y;
-	y = z;
-	z = t ^ x ^ y;
+// latency를 따로 모으는 연산 종류. Func::Add부터 순서대로
+constexpr size_t NUM_OP_TYPES = 5;
+const char *const OP_NAMES[NUM_OP_TYPES] = {"Add     ", "Remove  ", "Contains", "RangeCnt", "RangeScn"};
+// range 연산의 latency는 --mix로 range 비율을 줬을 때만 출력
+constexpr size_t NUM_POINT_OP_TYPES = 3;
+using SkiplistLatency = OpLatency<NUM_OP_TYPES>;
 
-	return z;
-}
-
-constexpr int MAXHEIGHT = 10;
-class SLNODE
+size_t op_type(Func func)
 {
-public:
-	int key;
-	array<SLNODE *, MAXHEIGHT> next;
-	int height;
-	SLNODE(int x, int h)
-	{
-		key = x;
-		height = h;
-		for (auto &p : next)
-			p = nullptr;
-	}
-	SLNODE(int x)
-	{
-		key = x;
-		height = MAXHEIGHT;
-		for (auto &p : next)
-			p = nullptr;
-	}
-	SLNODE()
-	{
-		key = 0;
-		height = MAXHEIGHT;
-		for (auto &p : next)
-			p = nullptr;
-	}
-};
+	return static_cast<size_t>(func) - static_cast<size_t>(Func::Add);
+}
 
-class SKLIST
+HistoryOp history_op(Func func)
 {
-	struct CopyingInfo
-	{
-		const SLNODE *org;
-		SLNODE *curr;
-		int level;
-
-		CopyingInfo() {}
-		CopyingInfo(const SLNODE *org, SLNODE *curr, int level) : org{org}, curr{curr}, level{level} {}
-	};
-
-	SLNODE head, tail;
-
-public:
-	SKLIST()
-	{
-		head.key = 0x80000000;
-		tail.key = 0x7FFFFFFF;
-		head.height = tail.height = MAXHEIGHT;
-		for (auto &p : head.next)
-			p = &tail;
-	}
-	~SKLIST()
-	{
-		Init();
-	}
-	SKLIST(const SKLIST &other) : SKLIST()
+	switch (func)
 	{
-		copy_and_link(other, *this);
+	case Func::Add:
+		return HistoryOp::Add;
+	case Func::Remove:
+		return HistoryOp::Remove;
+	default:
+		return HistoryOp::Contains;
 	}
-	SKLIST(SKLIST &&other) : head{move(other.head)}, tail{move(other.tail)}
-	{
-		for (auto &p : other.head.next)
-		{
-			p = &other.tail;
-		}
-	}
-
-	SKLIST &operator=(const SKLIST &other)
-	{
-		Init();
-		// tuple<original_node, current_node, highest_unlinked_level>
-		copy_and_link(other, *this);
-		return *this;
-	}
-	SKLIST &operator=(SKLIST &&other)
-	{
-		this->head = move(other.head);
-		this->tail = move(other.tail);
-		for (auto &p : other.head.next)
-		{
-			p = &other.tail;
-		}
-		return *this;
-	}
-
-	static void copy_and_link(const SKLIST &from, SKLIST &to)
-	{
-		unordered_map<const SLNODE *, SLNODE *> ptr_map;
-		ptr_map[&from.tail] = &to.tail;
-
-		auto from_node = &from.head;
-		auto to_node = &to.head;
-		while (from_node->next[0] != nullptr)
-		{
-			for (auto i = 0; i < from_node->height; ++i)
-			{
-				const SLNODE *const from_next = from_node->next[i];
-				auto &to_next = to_node->next[i];
-
-				auto it = ptr_map.find(from_next);
-				if (it == ptr_map.end())
-				{
-					auto new_node = new SLNODE{from_next->key, from_next->height};
-					to_next = new_node;
-					ptr_map.emplace(from_next, new_node);
-				}
-				else
-				{
-					to_next = it->second;
-				}
-			}
-			from_node = from_node->next[0];
-			to_node = to_node->next[0];
-		}
-	}
-
-	void Init()
-	{
-		SLNODE *ptr;
-		while (head.next[0] != &tail)
-		{
-			ptr = head.next[0];
-			head.next[0] = head.next[0]->next[0];
-			delete ptr;
-		}
-		for (auto &p : head.next)
-			p = &tail;
-	}
-	void Find(int key, SLNODE *preds[MAXHEIGHT], SLNODE *currs[MAXHEIGHT])
-	{
-		for (auto cl = MAXHEIGHT - 1; 0 <= cl; --cl)
-		{
-			if (MAXHEIGHT - 1 == cl)
-				preds[cl] = &head;
-			else
-				preds[cl] = preds[cl + 1];
-			currs[cl] = preds[cl]->next[cl];
-			while (currs[cl]->key < key)
-			{
-				preds[cl] = currs[cl];
-				currs[cl] = currs[cl]->next[cl];
-			}
-		}
-	}
-
-	bool Add(int key)
-	{
-		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
-
-		Find(key, preds, currs);
-
-		if (key == currs[0]->key)
-		{
-			return false;
-		}
-		else
-		{
-			int height = 1;
-			while (fast_rand() % 2 == 0)
-			{
-				height++;
-				if (MAXHEIGHT == height)
-					break;
-			}
-			SLNODE *node = new SLNODE(key, height);
-			for (int i = 0; i < height; ++i)
-			{
-				preds[i]->next[i] = node;
-				node->next[i] = currs[i];
-			}
-
-			return true;
-		}
-	}
-	bool Remove(int key)
-	{
-		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
-
-		Find(key, preds, currs);
-
-		if (key == currs[0]->key)
-		{
-			for (int i = 0; i < currs[0]->height; ++i)
-			{
-				preds[i]->next[i] = currs[i]->next[i];
-			}
-			delete currs[0];
-			return true;
-		}
-		else
-		{
-			return false;
-		}
-	}
-	bool Contains(int key)
-	{
-		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
-		Find(key, preds, currs);
-		if (key == currs[0]->key)
-		{
-			return true;
-		}
-		else
-		{
-			return false;
-		}
-	}
-
-	void display20()
-	{
-		int c = 20;
-		SLNODE *p = head.next[0];
-		while (p != &tail)
-		{
-			cout << p->key << ", ";
-			p = p->next[0];
-			c--;
-			if (c == 0)
-				break;
-		}
-		cout << endl;
-	}
-};
+}
 
-enum class Func
+struct alignas(64) ThreadResult
 {
-	None,
-	Add,
-	Remove,
-	Contains,
+	long long num_ops = 0;
+	SkiplistLatency latency;
+	ThreadPlacement placement;
 };
 
-struct Invoc
+void ThreadFunc(SkiplistUC *list, const Workload *workload, const vector<int> *cpus, HistoryRecorder *history, int num_thread, int thread_id,
+				const atomic_bool *stop, ThreadResult *result)
 {
-	Func func;
-	int arg;
-
-	Invoc(Func func, int arg = 0) : func{func}, arg{arg} {}
-
-	bool is_read_only() const
-	{
-		return func == Func::Contains;
-	}
-};
-
-using Response = int;
+	// replica를 고르는 node가 thread가 처음 돈 CPU로 정해지므로 연산 전에 고정
+	pin_thread(*cpus, thread_id);
+	OpGenerator gen{*workload, thread_id};
+	const auto num_ops = workload->duration_ms > 0 ? LLONG_MAX : workload->num_ops / num_thread;
+
+	for (long long i = 0; i < num_ops; i++)
+	{
+		if (workload->duration_ms > 0 && stop->load(memory_order_relaxed))
+			break;
+		// history buffer가 차면 더 기록할 수 없으므로 이 thread는 멈춤
+		if (history != nullptr && history->full(thread_id))
+			break;
+		const auto invoc = gen.next();
+		const auto op_begin = LatencyClock::now();
+		const auto response = list->apply(invoc, thread_id);
+		// range 연산은 key 하나에 대한 연산이 아니므로 key별로 검사하는 history에는 넣지 않음
+		if (history != nullptr && invoc.func != Func::RangeCount && invoc.func != Func::RangeScan)
+			history->record(thread_id, history_op(invoc.func), invoc.arg, response.value_or(0) != 0, op_begin, LatencyClock::now());
+		result->latency.record(op_type(invoc.func), op_begin);
+		++result->num_ops;
+	}
+	result->placement = ThreadPlacement::current();
+}
 
-struct Node
+struct BenchResult
 {
-	Invoc invoc;
-	uint64_t seq;
-	atomic<Node *> next;
-
-	Node(const Invoc &invoc) : invoc{invoc}, seq{0}, next{nullptr} {}
+	chrono::milliseconds duration;
+	long long num_ops;
+	// 측정이 끝났을 때의 replica 개수
+	int replicas;
+	SkiplistLatency latency;
+	// 측정 구간 동안의 최대 / 끝난 뒤의 RSS (KB)
+	uint64_t peak_rss_kb;
+	uint64_t end_rss_kb;
+	SkiplistUC::Telemetry telemetry;
+	// 모든 replica가 확보한 skiplist node 수
+	uint64_t replica_nodes;
+	vector<ThreadPlacement> placements;
+	// --check로 검사했을 때만 있음
+	optional<LinearizabilityReport> check;
 };
 
-struct Object
+// 측정 전에 서로 다른 key를 workload.prefill개 넣어둔다. 분포가 치우쳐 있어도 금방 채워지도록 uniform으로 고름.
+void prefill(SkiplistUC &list, const Workload &workload, HistoryRecorder *history)
 {
-	SKLIST container;
-
-	Response apply(const Invoc &invoc)
+	auto uniform = workload;
+	uniform.dist = KeyDist::Uniform;
+	OpGenerator gen{uniform, MAX_THREAD};
+	for (auto inserted = 0; inserted < workload.prefill;)
 	{
-		switch (invoc.func)
+		const auto key = gen.next_key();
+		if (list.apply(Invoc(Func::Add, key), 0).value_or(0))
 		{
-		case Func::Add:
-			return container.Add(invoc.arg);
-		case Func::Remove:
-			return container.Remove(invoc.arg);
-		case Func::Contains:
-			return container.Contains(invoc.arg);
-		default:
-			cerr << "Unknown Method" << endl;
-			return 0;
+			++inserted;
+			if (history != nullptr)
+				history->add_initial(key);
 		}
 	}
+}
 
-	void init()
-	{
-		container.Init();
-	}
-};
-
-struct Combined
-{
-	Object obj;
-	shared_mutex rw_lock;
-	Node *last_node;
-
-	Combined(Node &node) : last_node{&node} {}
-};
-
-constexpr int RECYCLE_RATE = 1000;
-
-class OLFUniversal
+// 한 번의 측정 동안 sampling한 RSS를 CSV로 덧붙인다.
+void append_rss_log(const Workload &workload, int num_thread, WriteMode write_mode, const RssSampler &sampler)
 {
-public:
-	OLFUniversal(int capacity) : capacity{capacity}, invoke_num{0}
-	{
-		Invoc invoc{Func::None};
-		tail = new Node(move(invoc));
-		tail->seq = 1;
-		head.store(tail, memory_order_relaxed);
-		combined_list.reserve(capacity);
-		for (auto i = 0; i < capacity; ++i)
-		{
-			combined_list.emplace_back(new Combined(*tail));
-		}
-	}
-	~OLFUniversal()
-	{
-		Node *cur = tail->next.load(memory_order_relaxed);
-		while (cur->next != nullptr)
-		{
-			Node *del = cur;
-			cur = cur->next.load(memory_order_relaxed);
-			delete del;
-		}
-		delete cur;
-		delete tail;
-		for (auto c : combined_list)
-		{
-			delete c;
-		}
-	}
-
-	Object &current_obj()
+	FILE *fp = fopen(workload.rss_log.c_str(), "a");
+	if (fp == nullptr)
 	{
-		Node *m = combined_list[0]->last_node;
-		int thread_id = 0;
-		int index = 1;
-		for (auto it = combined_list.begin() + 1; it != combined_list.end(); ++it, ++index)
-		{
-			if ((*it)->last_node == nullptr)
-				continue;
-			if (m->seq < (*it)->last_node->seq)
-			{
-				m = (*it)->last_node;
-				thread_id = index;
-			}
-		}
-		return combined_list[thread_id]->obj;
+		perror(workload.rss_log.c_str());
+		return;
 	}
-
-	void update_combinded(Combined *target, const unique_lock<shared_mutex> &lg)
+	if (ftell(fp) == 0)
+		fprintf(fp, "mode,threads,read,time_ms,rss_kb,log_reclaims\n");
+	for (auto &s : sampler.samples())
 	{
-		while (true)
-		{
-			for (auto comb : combined_list)
-			{
-				if (comb == target)
-					continue;
-
-				shared_lock<shared_mutex> slg{comb->rw_lock};
-				if (comb->last_node == nullptr)
-					continue;
-
-				target->obj = comb->obj;
-				target->last_node = comb->last_node;
-				return;
-			}
-		}
+		fprintf(fp, "%s,%d,%d,%llu,%llu,%llu\n", to_string(write_mode), num_thread, workload.read, static_cast<unsigned long long>(s.time_ms),
+				static_cast<unsigned long long>(s.rss_kb), static_cast<unsigned long long>(s.probe));
 	}
+	fclose(fp);
+}
 
-	optional<pair<shared_lock<shared_mutex>, Combined &>> get_comb_read(const Node& old_head)
-	{
-		shared_lock<shared_mutex> lg;
-		for (auto comb : combined_list)
-		{
-			lg = shared_lock<shared_mutex>{comb->rw_lock, try_to_lock};
-			if (lg)
-			{
-				if (comb->last_node == nullptr)
-					continue;
-
-				else if (old_head.seq == comb->last_node->seq)
-					return make_pair(move(lg), ref(*comb));
-			}
-		}
-		return nullopt;
-	}
+BenchResult run_bench(const Workload &workload, int num_thread, WriteMode write_mode)
+{
+	// 정해진 연산 수로 돌 때는 thread마다 정확히 그만큼, 시간으로 돌 때는 --history만큼 기록할 자리를 둠
+	unique_ptr<HistoryRecorder> history;
+	if (workload.check)
+	{
+		const auto capacity = workload.duration_ms > 0 ? workload.history_capacity : static_cast<size_t>(workload.num_ops / num_thread);
+		history = make_unique<HistoryRecorder>(num_thread, capacity);
+	}
+
+	const bool exact_peak = reset_peak_rss();
+	SkiplistUC list = workload.replicas > 0 ? SkiplistUC(workload.replicas, workload.log_mode, write_mode)
+											: SkiplistUC(1, num_thread, workload.log_mode, write_mode);
+	prefill(list, workload, history.get());
+	vector<ThreadResult> results(num_thread);
+	atomic_bool stop{false};
+	RssSampler sampler{milliseconds(workload.rss_interval_ms), [&list] { return list.num_log_reclaims(); }};
+
+	const auto cpus = CpuTopology::get().order(workload.pin);
+	vector<thread> threads;
+	auto s = high_resolution_clock::now();
+	for (int i = 0; i < num_thread; ++i)
+		threads.emplace_back(ThreadFunc, &list, &workload, &cpus, history.get(), num_thread, i, &stop, &results[i]);
+	if (workload.duration_ms > 0)
+	{
+		this_thread::sleep_for(milliseconds(workload.duration_ms));
+		stop.store(true, memory_order_relaxed);
+	}
+	for (auto &th : threads)
+		th.join();
+	auto d = high_resolution_clock::now() - s;
+	sampler.stop();
+
+	if (workload.format == OutputFormat::Text)
+		list.current_obj().container.display20();
 
-	pair<unique_lock<shared_mutex>, Combined &> get_comb()
+	BenchResult result{duration_cast<milliseconds>(d), 0, list.num_replicas(), {}, 0, current_rss_kb(), list.telemetry(), 0, {}, {}};
+	for (auto &r : results)
 	{
-		unique_lock<shared_mutex> lg;
-		do
-		{
-			for (auto comb : combined_list)
-			{
-				lg = unique_lock<shared_mutex>{comb->rw_lock, try_to_lock};
-				if (lg)
-				{
-					bool is_obj_exist = false;
-					if (comb->last_node == nullptr)
-					{
-						update_combinded(comb, lg);
-					}
-					return make_pair(move(lg), ref(*comb));
-				}
-			}
-		} while (true);
+		result.num_ops += r.num_ops;
+		result.latency.merge(r.latency);
+		result.placements.push_back(r.placement);
 	}
+	// clear_refs를 쓸 수 없으면 sampling한 값 중 최댓값으로 대신함
+	result.peak_rss_kb = exact_peak ? peak_rss_kb() : sampler.max_sampled_kb();
+	list.visit_objects([&result](const SkiplistObject &obj) { result.replica_nodes += obj.container.allocated_nodes(); });
 
-	optional<Response> update_local_obj(const Node& prefer, bool is_write)
-	{
-		optional<Response> result;
-		const auto until_seq = prefer.seq;
-		{
-			auto &&[lg, comb] = get_comb();
-			assert(lg && "a lock guard didn't get its mutex");
-
-			auto &last_node = comb.last_node;
-			auto &last_obj = comb.obj;
-
-			if (last_node->seq >= until_seq)
-			{
-				return nullopt;
-			}
-			last_node = last_node->next.load(memory_order_relaxed);
-			while (last_node->seq < until_seq)
-			{
-				last_obj.apply(last_node->invoc);
-				last_node = last_node->next.load(memory_order_relaxed);
-			}
-
-			result = last_obj.apply(last_node->invoc);
-		}
-
-		if (is_write && invoke_num.load(memory_order_relaxed) < RECYCLE_RATE)
-		{
-			if (invoke_num.fetch_add(1, memory_order_relaxed) + 1 == RECYCLE_RATE)
-			{
-				recycle();
-				invoke_num.store(0, memory_order_relaxed);
-			}
-		}
-
-		return result;
-	}
-
-	optional<Response> apply(const Invoc &invoc)
-	{
-		if (invoc.is_read_only())
-		{
-			return do_read_only(invoc);
-		}
-
-		Node *prefer = new Node(invoc);
-		while (true)
-		{
-			Node *old_head = head.load(memory_order_relaxed);
-			Node *old_next = old_head->next.load(memory_order_relaxed);
-			if (old_next != nullptr)
-			{
-				head.compare_exchange_strong(old_head, old_next);
-				continue;
-			}
-
-			prefer->seq = old_head->seq + 1;
-			if (true == old_head->next.compare_exchange_strong(old_next, prefer))
-			{
-				head.compare_exchange_strong(old_head, prefer);
-				break;
-			}
-		}
-
-		return update_local_obj(*prefer, true);
-	}
-
-	optional<Response> do_read_only(const Invoc &invoc)
-	{
-		auto old_head = head.load(memory_order_relaxed);
-		auto ret = get_comb_read(*old_head);
-		if (ret)
-		{
-			auto&& [lg, comb] = move(*ret);
-			assert(lg && "a lock guard didn't get its mutex");
-			return comb.obj.apply(invoc);
-		} else {
-			return update_local_obj(*old_head, false);
-		}
-	}
+	if (!workload.rss_log.empty())
+		append_rss_log(workload, num_thread, write_mode, sampler);
+	if (history)
+		result.check = check_set_linearizability(*history);
+	return result;
+}
 
-	void remove_until_seq(uint64_t until_seq)
-	{
-		auto old_next = tail->next.load(memory_order_relaxed);
-		if (until_seq <= old_next->seq)
-		{
-			return;
-		}
+double throughput(const BenchResult &result)
+{
+	return result.duration.count() == 0 ? 0.0 : result.num_ops * 1000.0 / result.duration.count();
+}
 
-		do
-		{
-			auto tmp = old_next;
-			old_next = old_next->next.load(memory_order_relaxed);
-			delete tmp;
-		} while (old_next->seq < until_seq);
-		tail->next.store(old_next, memory_order_relaxed);
+void print_header(const Workload &workload)
+{
+	switch (workload.format)
+	{
+	case OutputFormat::Text:
+		CpuTopology::get().describe(cout);
+		cout << "Log Mode : " << to_string(workload.log_mode) << ",  Pin : " << to_string(workload.pin) << endl;
+		break;
+	case OutputFormat::Csv:
+		cout << "mode,log,threads,replicas,read,add,remove,keys,dist,prefill,ops,duration_ms,ops_per_sec,p50_ns,p99_ns,p999_ns,max_ns,add_p99_ns,remove_p99_ns,contains_p99_ns,"
+				"peak_rss_kb,end_rss_kb,log_nodes_allocated,log_nodes_reused,replicas_allocated,replicas_freed,replica_nodes,log_reclaims,pin,placement,linearizable,"
+				"range,range_len,range_count_p99_ns,range_scan_p99_ns"
+			 << endl;
+		break;
+	case OutputFormat::Json:
+		break;
 	}
+}
 
-	void recycle()
-	{
-		size_t num_to_remove = RECYCLE_RATE / 2;
-		auto min_seq = tail->next.load(memory_order_relaxed)->seq + num_to_remove;
-
-		for (auto comb : combined_list)
-		{
-			if (comb->last_node == nullptr)
-				continue;
-			// comb->last_node를 초기화 하는 thread는 현재 자신 밖에 없으므로 lock 없이 읽어도 안전.
-			if (comb->last_node->seq < min_seq)
-			{
-				unique_lock<shared_mutex> lg{comb->rw_lock};
-
-				comb->last_node = nullptr;
-				comb->obj.init();
-			}
-		}
-
-		// combine을 초기화하며 진행하는 도중에, 이미 초기화된 comb에 접근해서 조금 뒤에 초기화 될 comb를 복제하면 오류날 수 있음
-		// 다시한번 loop를 돌면서 오래된 seq가 있지는 않는지 확인
-		for (auto comb : combined_list)
-		{
-			shared_lock<shared_mutex> lg{comb->rw_lock};
-			if (comb->last_node == nullptr)
-				continue;
-
-			if (comb->last_node->seq < min_seq) {
-				min_seq = comb->last_node->seq;
-			}
-		}
-
-		remove_until_seq(min_seq);
+void print_result(const Workload &workload, int num_thread, WriteMode write_mode, const BenchResult &result)
+{
+	const auto total = result.latency.total();
+	const auto p50 = total.percentile(0.5);
+	const auto p99 = total.percentile(0.99);
+	const auto p999 = total.percentile(0.999);
+	const auto &t = result.telemetry;
+	switch (workload.format)
+	{
+	case OutputFormat::Text:
+		cout << num_thread << "Threads";
+		if (workload.write_modes.size() > 1 || write_mode != WriteMode::LockFree)
+			cout << ",  " << to_string(write_mode);
+		cout << ",  Duration : " << result.duration.count() << " msecs";
+		cout << ",  Replicas : " << result.replicas;
+		cout << ",  p50 : " << p50 << " ns";
+		cout << ",  p99 : " << p99 << " ns";
+		cout << ",  p99.9 : " << p999 << " ns";
+		cout << ",  max : " << total.max() << " ns." << endl;
+		for (size_t op = 0; op < (workload.range > 0 ? NUM_OP_TYPES : NUM_POINT_OP_TYPES); ++op)
+			print_latency_line(cout, OP_NAMES[op], result.latency[op]);
+		cout << "    Peak RSS : " << result.peak_rss_kb << " KB,  End RSS : " << result.end_rss_kb << " KB";
+		cout << ",  Log Nodes : " << t.log_nodes_allocated << " allocated / " << t.log_nodes_reused << " reused";
+		cout << ",  Replicas : " << t.replicas_allocated << " allocated / " << t.replicas_freed << " freed";
+		cout << ",  Replica Nodes : " << result.replica_nodes << ",  Log Reclaims : " << t.log_reclaims << endl;
+		print_placement(cout, result.placements.begin(), result.placements.end());
+		if (result.check)
+			result.check->print(cout);
+		break;
+	case OutputFormat::Csv:
+		cout << to_string(write_mode) << ',' << to_string(workload.log_mode) << ',' << num_thread << ',' << result.replicas << ','
+			 << workload.read << ',' << workload.add << ',' << workload.remove << ',' << workload.key_range << ',' << to_string(workload.dist) << ','
+			 << workload.prefill << ',' << result.num_ops << ',' << result.duration.count() << ',' << static_cast<long long>(throughput(result)) << ','
+			 << p50 << ',' << p99 << ',' << p999 << ',' << total.max() << ',' << result.latency[0].percentile(0.99) << ','
+			 << result.latency[1].percentile(0.99) << ',' << result.latency[2].percentile(0.99) << ',' << result.peak_rss_kb << ',' << result.end_rss_kb << ',' << t.log_nodes_allocated << ','
+			 << t.log_nodes_reused << ',' << t.replicas_allocated << ',' << t.replicas_freed << ',' << result.replica_nodes << ',' << t.log_reclaims
+			 << ',' << to_string(workload.pin) << ',' << placement_string(result.placements.begin(), result.placements.end()) << ','
+			 << (result.check ? result.check->verdict() : "-") << ',' << workload.range << ',' << workload.range_len << ','
+			 << result.latency[3].percentile(0.99) << ',' << result.latency[4].percentile(0.99) << endl;
+		break;
+	case OutputFormat::Json:
+		// 한 줄에 하나씩 (JSON Lines)
+		cout << "{\"mode\":\"" << to_string(write_mode) << "\",\"log\":\"" << to_string(workload.log_mode) << "\",\"threads\":" << num_thread
+			 << ",\"replicas\":" << result.replicas << ",\"read\":" << workload.read << ",\"add\":" << workload.add << ",\"remove\":" << workload.remove
+			 << ",\"keys\":" << workload.key_range << ",\"dist\":\"" << to_string(workload.dist) << "\",\"prefill\":" << workload.prefill
+			 << ",\"ops\":" << result.num_ops << ",\"duration_ms\":" << result.duration.count()
+			 << ",\"ops_per_sec\":" << static_cast<long long>(throughput(result)) << ",\"p50_ns\":" << p50 << ",\"p99_ns\":" << p99
+			 << ",\"p999_ns\":" << p999 << ",\"max_ns\":" << total.max() << ",\"add_p99_ns\":" << result.latency[0].percentile(0.99)
+			 << ",\"remove_p99_ns\":" << result.latency[1].percentile(0.99) << ",\"contains_p99_ns\":" << result.latency[2].percentile(0.99)
+			 << ",\"peak_rss_kb\":" << result.peak_rss_kb << ",\"end_rss_kb\":" << result.end_rss_kb
+			 << ",\"log_nodes_allocated\":" << t.log_nodes_allocated << ",\"log_nodes_reused\":" << t.log_nodes_reused
+			 << ",\"replicas_allocated\":" << t.replicas_allocated << ",\"replicas_freed\":" << t.replicas_freed
+			 << ",\"replica_nodes\":" << result.replica_nodes << ",\"log_reclaims\":" << t.log_reclaims
+			 << ",\"pin\":\"" << to_string(workload.pin) << "\",\"placement\":\"" << placement_string(result.placements.begin(), result.placements.end())
+			 << "\",\"linearizable\":\"" << (result.check ? result.check->verdict() : "-") << "\",\"range\":" << workload.range
+			 << ",\"range_len\":" << workload.range_len << ",\"range_count_p99_ns\":" << result.latency[3].percentile(0.99)
+			 << ",\"range_scan_p99_ns\":" << result.latency[4].percentile(0.99) << "}" << endl;
+		break;
 	}
+}
 
-private:
-	// 가장 최근 Node
-	atomic<Node *> head;
-	vector<Combined *> combined_list;
-	// 가장 오래된 Node
-	Node *tail;
-	int capacity;
-	atomic_ullong invoke_num;
-};
-
-const auto NUM_TEST = 4000000;
-const auto KEY_RANGE = 1000;
-void ThreadFunc(OLFUniversal *list, int num_thread, int thread_id)
+// 인자는 workload.h의 print_usage 참고. 인자가 없으면 예전과 같은 조건(Contains 30%, key 1000개, 400만 번)으로 측정.
+int main(int argc, char *argv[])
 {
-	int key;
+	const auto workload = parse_workload(argc, argv);
 
-	for (int i = 0; i < NUM_TEST / num_thread; i++)
+	print_header(workload);
+	for (auto n : workload.threads)
 	{
-		auto ticket = fast_rand() % 100;
-		auto pivot = (100 - READ_PROPORTION) / 2;
-		if (ticket < READ_PROPORTION)
+		for (auto write_mode : workload.write_modes)
 		{
-			// contains
-			key = fast_rand() % KEY_RANGE;
-			list->apply(Invoc(Func::Contains, key));
+			print_result(workload, n, write_mode, run_bench(workload, n, write_mode));
 		}
-		else if (ticket - READ_PROPORTION < pivot)
-		{
-			// add
-			key = fast_rand() % KEY_RANGE;
-			list->apply(Invoc(Func::Add, key));
-		}
-		else
-		{
-			// remove
-			key = fast_rand() % KEY_RANGE;
-			list->apply(Invoc(Func::Remove, key));
-		}
-	}
-}
-
-int main()
-{
-	for (auto n = 1; n <= 64; n *= 2)
-	{
-		OLFUniversal list(n);
-
-		vector<thread> threads;
-		auto s = high_resolution_clock::now();
-		for (int i = 0; i < n; ++i)
-			threads.emplace_back(ThreadFunc, &list, n, i);
-		for (auto &th : threads)
-			th.join();
-		auto d = high_resolution_clock::now() - s;
-
-		list.current_obj().container.display20();
-		cout << n << "Threads";
-		cout << ",  Duration : " << duration_cast<milliseconds>(d).count() << " msecs." << endl;
 	}
 }
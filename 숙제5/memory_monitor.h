@@ -0,0 +1,140 @@
+#ifndef A9D3E61F_4B27_4C85_B0E9_7C1F26D84A53
+#define A9D3E61F_4B27_4C85_B0E9_7C1F26D84A53
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// /proc/self/status에서 읽은 값 (KB). 읽지 못하면 0.
+inline uint64_t read_status_kb(const char *field)
+{
+	FILE *fp = fopen("/proc/self/status", "r");
+	if (fp == nullptr)
+		return 0;
+
+	const auto field_len = strlen(field);
+	char line[256];
+	uint64_t value = 0;
+	while (fgets(line, sizeof(line), fp) != nullptr)
+	{
+		if (strncmp(line, field, field_len) == 0 && line[field_len] == ':')
+		{
+			value = strtoull(line + field_len + 1, nullptr, 10);
+			break;
+		}
+	}
+	fclose(fp);
+	return value;
+}
+
+inline uint64_t current_rss_kb()
+{
+	return read_status_kb("VmRSS");
+}
+
+// 이 process가 지금까지 가장 많이 쓴 RSS. reset_peak_rss() 이후의 최댓값.
+inline uint64_t peak_rss_kb()
+{
+	return read_status_kb("VmHWM");
+}
+
+// VmHWM을 현재 RSS로 되돌린다. 측정마다 호출하면 그 측정 동안의 최댓값을 sampling 간격과 상관없이 정확히 얻을 수 있음.
+inline bool reset_peak_rss()
+{
+	FILE *fp = fopen("/proc/self/clear_refs", "w");
+	if (fp == nullptr)
+		return false;
+	const auto ok = fputs("5", fp) >= 0;
+	fclose(fp);
+	return ok;
+}
+
+// 측정하는 동안 별도 thread에서 interval마다 RSS를 읽어 기록한다.
+// probe를 주면 같은 시점의 값(예: log 정리 횟수)을 함께 기록하므로 memory 변화와 맞춰볼 수 있음.
+class RssSampler
+{
+public:
+	struct Sample
+	{
+		uint64_t time_ms;
+		uint64_t rss_kb;
+		uint64_t probe;
+	};
+
+	RssSampler(std::chrono::milliseconds interval, std::function<uint64_t()> probe = nullptr) : interval{interval}, probe{std::move(probe)}
+	{
+		begin = std::chrono::steady_clock::now();
+		if (interval.count() > 0)
+			worker = std::thread{[this] { run(); }};
+	}
+	RssSampler(const RssSampler &) = delete;
+	RssSampler &operator=(const RssSampler &) = delete;
+	~RssSampler()
+	{
+		stop();
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lg{lock};
+			stopped = true;
+		}
+		cv.notify_all();
+		if (worker.joinable())
+		{
+			worker.join();
+			take_sample();
+		}
+	}
+
+	// stop() 이후에만 호출
+	const std::vector<Sample> &samples() const
+	{
+		return history;
+	}
+
+	uint64_t max_sampled_kb() const
+	{
+		uint64_t max_kb = 0;
+		for (auto &s : history)
+			max_kb = std::max(max_kb, s.rss_kb);
+		return max_kb;
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lg{lock};
+		while (!stopped)
+		{
+			take_sample();
+			cv.wait_for(lg, interval);
+		}
+	}
+
+	void take_sample()
+	{
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+		history.push_back(Sample{static_cast<uint64_t>(elapsed.count()), current_rss_kb(), probe ? probe() : 0});
+	}
+
+	const std::chrono::milliseconds interval;
+	const std::function<uint64_t()> probe;
+	std::chrono::steady_clock::time_point begin;
+	std::vector<Sample> history;
+	std::mutex lock;
+	std::condition_variable cv;
+	bool stopped = false;
+	std::thread worker;
+};
+
+#endif /* A9D3E61F_4B27_4C85_B0E9_7C1F26D84A53 */
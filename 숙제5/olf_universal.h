@@ -0,0 +1,1036 @@
+#ifndef D8A61E0B_3C4F_4E0A_9F2D_6B1C7E52A9F4
+#define D8A61E0B_3C4F_4E0A_9F2D_6B1C7E52A9F4
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sched.h>
+#include <numa.h>
+#include "numa_util.h"
+
+// Object(순차 자료구조)와 그 invocation 타입만 주면 replica/log 기반의 universal construction을 만들어준다.
+//
+// Object에 필요한 것
+//  - 기본 생성자, 복사 대입 (재활용된 replica를 다른 replica로부터 복구할 때 사용)
+//  - Response apply(const Invoc &)
+//  - (선택) std::optional<Response> try_read(const Invoc &) const
+//      다른 thread가 수정 중일 수도 있는 상태에서 읽기 전용 invocation을 수행. 있으면 reader가 lock 없이 읽음.
+//  - (선택) void apply_batch(const std::vector<Invoc> &, std::vector<Response> &)
+//      밀린 log를 한꺼번에 적용하고 각각의 결과를 채움. 없으면 하나씩 apply.
+//
+// Invoc은 기본 생성 가능해야 하며 (log의 sentinel에 사용), 읽기 전용 여부는 InvocTraits로 판단한다.
+// Response는 log node에 atomic으로 기록되므로 trivially copyable 이어야 함.
+
+template <typename Invoc>
+struct InvocTraits
+{
+	static bool is_read_only(const Invoc &invoc)
+	{
+		return invoc.is_read_only();
+	}
+};
+
+constexpr int RECYCLE_RATE = 1000;
+// replica가 이 개수 이상 밀려 있으면 log를 모아서 일괄 적용
+constexpr uint64_t BATCH_THRESHOLD = 64;
+constexpr int MAX_THREAD = 64;
+constexpr int MAX_REPLICA = MAX_THREAD;
+constexpr int MAX_NODE = 8;
+// replica 개수를 자동으로 조절할 때, recycle/compact 한 주기 동안 모든 replica가 사용 중이라 한 바퀴를 헛돈 횟수가 이만큼 쌓이면 replica를 하나 늘림
+constexpr uint64_t GROW_THRESHOLD = 16;
+// recycle/compact 주기 동안 한 번도 헛돌지 않은 주기가 이만큼 이어지면 replica를 하나 줄임
+constexpr int SHRINK_PERIODS = 8;
+
+inline const int NODE_NUM = numa_available() < 0 ? 1 : std::min(numa_num_configured_nodes(), MAX_NODE);
+
+enum class LogMode
+{
+	// 오래된 replica를 비우고 그 replica가 참조하던 log를 해제
+	Recycle,
+	// replica는 유지하고 모든 replica가 지나간 log만 epoch 기반으로 해제
+	Compact,
+};
+
+enum class WriteMode
+{
+	// 각 writer가 직접 log에 node를 붙이고 replica에 적용
+	LockFree,
+	// writer는 publication record에 invocation만 올리고, combiner 하나가 모아서 처리
+	FlatCombining,
+	// writer가 announce array에 node를 올리고, 다른 thread들이 순번에 따라 대신 붙여줌. log에 붙는 것은 wait-free
+	WaitFree,
+};
+
+template <typename Object, typename Invoc, typename Response, typename = void>
+struct HasTryRead : std::false_type
+{
+};
+template <typename Object, typename Invoc, typename Response>
+struct HasTryRead<Object, Invoc, Response,
+				  std::void_t<decltype(std::declval<const Object &>().try_read(std::declval<const Invoc &>()))>> : std::true_type
+{
+};
+
+template <typename Object, typename Invoc, typename Response, typename = void>
+struct HasApplyBatch : std::false_type
+{
+};
+template <typename Object, typename Invoc, typename Response>
+struct HasApplyBatch<Object, Invoc, Response,
+					 std::void_t<decltype(std::declval<Object &>().apply_batch(std::declval<const std::vector<Invoc> &>(),
+																			   std::declval<std::vector<Response> &>()))>> : std::true_type
+{
+};
+
+// invocation은 가상 함수 없이 log node 안에 그대로 저장된다.
+template <typename Invoc, typename Response>
+struct Node
+{
+	Invoc invoc;
+	// log에 붙은 뒤에 정해진다. 다른 thread가 대신 붙여준 경우 그 thread가 기록하므로 atomic.
+	std::atomic_uint64_t seq;
+	std::atomic<Node *> next;
+	// 이 invocation을 처음 적용한 replica가 기록한 결과. replica들은 같은 log를 순서대로 적용하므로 어느 replica에서든 같은 값.
+	std::atomic<Response> response;
+
+	Node(const Invoc &invoc) : invoc{invoc}, seq{0}, next{nullptr}, response{} {}
+};
+
+// unique_lock<Combined>으로 잡으면 replica를 수정하는 동안 version이 홀수가 되므로
+// lock 없이 읽는 reader는 읽기 전후의 version을 비교해서 결과가 유효한지 알 수 있다.
+// shared_lock<Combined>은 replica를 복제하는 용도로만 사용.
+// 자주 접근하는 field들은 서로 다른 cache line에 둔다.
+// rw_lock은 replica를 찾는 모든 thread가 try_lock 하고, version/applied_seq는 reader가 계속 읽으며,
+// obj/last_node는 lock을 가진 thread만 건드림.
+template <typename Object, typename Invoc, typename Response>
+struct alignas(64) Combined
+{
+	using LogNode = Node<Invoc, Response>;
+
+	alignas(64) std::shared_mutex rw_lock;
+	alignas(64) std::atomic_ullong version;
+	// last_node->seq를 lock 없이 읽을 수 있도록 공개하는 값. 재활용되어 비어있는 replica는 0.
+	std::atomic_ullong applied_seq;
+	alignas(64) LogNode *last_node;
+	Object obj;
+
+	Combined(LogNode &node) : version{0}, applied_seq{node.seq}, last_node{&node} {}
+	// 비어있는 replica. 처음 잡은 thread가 다른 replica를 복제해서 채움.
+	Combined() : version{0}, applied_seq{0}, last_node{nullptr} {}
+
+	void lock()
+	{
+		rw_lock.lock();
+		begin_write();
+	}
+	bool try_lock()
+	{
+		if (false == rw_lock.try_lock())
+			return false;
+		begin_write();
+		return true;
+	}
+	void unlock()
+	{
+		version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		rw_lock.unlock();
+	}
+	void lock_shared()
+	{
+		rw_lock.lock_shared();
+	}
+	bool try_lock_shared()
+	{
+		return rw_lock.try_lock_shared();
+	}
+	void unlock_shared()
+	{
+		rw_lock.unlock_shared();
+	}
+
+	// seqlock 방식의 읽기. 읽는 동안 아무도 replica를 수정하지 않았을 때만 결과를 반환하며, 공유 메모리에 쓰지 않음.
+	std::optional<Response> try_read(const Invoc &invoc, uint64_t min_seq) const
+	{
+		auto begin_version = version.load(std::memory_order_acquire);
+		if (begin_version % 2 == 1)
+			return std::nullopt;
+		if (applied_seq.load(std::memory_order_relaxed) < min_seq)
+			return std::nullopt;
+
+		auto result = obj.try_read(invoc);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (version.load(std::memory_order_relaxed) != begin_version)
+			return std::nullopt;
+		return result;
+	}
+
+private:
+	void begin_write()
+	{
+		version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+};
+
+template <typename Object, typename Invoc, typename Response>
+class OLFUniversal
+{
+	static_assert(std::is_trivially_copyable_v<Response>, "Response is stored atomically in log nodes");
+
+	using Node = ::Node<Invoc, Response>;
+	using Combined = ::Combined<Object, Invoc, Response>;
+	using Traits = InvocTraits<Invoc>;
+
+	static constexpr bool has_try_read = HasTryRead<Object, Invoc, Response>::value;
+	static constexpr bool has_apply_batch = HasApplyBatch<Object, Invoc, Response>::value;
+
+	struct alignas(64) PubRecord
+	{
+		enum State
+		{
+			EMPTY,
+			PENDING,
+			DONE,
+		};
+		std::atomic_int state{EMPTY};
+		Invoc invoc{};
+		Response response;
+	};
+
+	// WaitFree mode에서 log에 붙기를 기다리는 node. 없으면 nullptr.
+	struct alignas(64) AnnounceSlot
+	{
+		std::atomic<Node *> node{nullptr};
+	};
+
+	// 재사용할 log node들의 thread별 free list. next로 연결되어 있음.
+	struct alignas(64) NodePool
+	{
+		Node *free_list = nullptr;
+		// 이 thread가 새로 할당한 / 재사용한 node 수
+		uint64_t allocated = 0;
+		uint64_t reused = 0;
+	};
+
+	struct alignas(64) EpochSlot
+	{
+		std::atomic_ullong epoch{ULLONG_MAX};
+	};
+
+	// [first, stop) 구간의 log node들. epoch보다 작은 epoch에 들어온 thread가 모두 나가면 해제 가능.
+	struct RetiredChain
+	{
+		uint64_t epoch;
+		Node *first;
+		Node *stop;
+	};
+
+	// 줄이면서 뺀 replica. 빼기 전에 목록을 읽은 thread가 아직 쓰고 있을 수 있음.
+	struct RetiredReplica
+	{
+		uint64_t epoch;
+		Combined *comb;
+	};
+
+	class EpochGuard
+	{
+	public:
+		EpochGuard(OLFUniversal &uc, int thread_id) : slot{uc.epoch_slots[thread_id].epoch}
+		{
+			slot.store(uc.global_epoch.load(std::memory_order_acquire));
+		}
+		~EpochGuard()
+		{
+			slot.store(ULLONG_MAX, std::memory_order_release);
+		}
+
+	private:
+		std::atomic_ullong &slot;
+	};
+
+public:
+	struct Telemetry
+	{
+		uint64_t log_nodes_allocated;
+		uint64_t log_nodes_reused;
+		uint64_t replicas_allocated;
+		uint64_t replicas_freed;
+		// recycle/compact 호출 횟수
+		uint64_t log_reclaims;
+	};
+
+	// replica를 capacity개로 고정
+	OLFUniversal(int capacity, LogMode log_mode = LogMode::Recycle, WriteMode write_mode = WriteMode::LockFree)
+		: OLFUniversal(capacity, capacity, log_mode, write_mode)
+	{
+	}
+	// replica를 min_replicas개로 시작해서, replica를 못 잡아 기다리는 일이 잦으면 max_replicas개까지 늘리고 한가하면 다시 줄인다.
+	// replica 개수는 thread 수와 상관없음.
+	OLFUniversal(int min_replicas, int max_replicas, LogMode log_mode = LogMode::Recycle, WriteMode write_mode = WriteMode::LockFree)
+		: min_replicas{min_replicas}, max_replicas{max_replicas}, num_active{min_replicas}, invoke_num{0}, log_mode{log_mode}, write_mode{write_mode},
+		  combiner_lock{false}, global_epoch{0}
+	{
+		assert(1 <= min_replicas && min_replicas <= max_replicas && max_replicas <= MAX_REPLICA);
+		tail = new Node(Invoc{});
+		tail->seq = 1;
+		head.store(tail, std::memory_order_relaxed);
+		// i번 replica는 (i % NODE_NUM)번 NUMA node의 메모리에 할당한다. 늘리고 줄여도 node별 개수가 고르게 유지됨.
+		for (auto i = 0; i < min_replicas; ++i)
+		{
+			combined_list[i].store(NUMA_alloc<Combined>(node_of_replica(i), *tail), std::memory_order_relaxed);
+		}
+		replicas_allocated.store(min_replicas, std::memory_order_relaxed);
+	}
+	~OLFUniversal()
+	{
+		for (auto &chain : retired_chains)
+		{
+			free_chain(chain);
+		}
+		for (auto &retired : retired_replicas)
+		{
+			NUMA_dealloc(retired.comb);
+		}
+
+		delete_list(tail);
+		delete_list(recycled_nodes.load(std::memory_order_relaxed));
+		for (auto &pool : node_pools)
+		{
+			delete_list(pool.free_list);
+		}
+		for_each_replica([](Combined *comb) { NUMA_dealloc(comb); });
+	}
+
+	Object &current_obj()
+	{
+		Combined *newest = nullptr;
+		for_each_replica([&newest](Combined *comb) {
+			if (comb->last_node == nullptr)
+				return;
+			if (newest == nullptr || newest->last_node->seq < comb->last_node->seq)
+				newest = comb;
+		});
+		if (newest == nullptr)
+			newest = combined_list[0].load(std::memory_order_relaxed);
+		return newest->obj;
+	}
+
+	int num_replicas() const
+	{
+		return num_active.load(std::memory_order_acquire);
+	}
+
+	// thread별 counter를 합친 값이므로 apply 중인 thread가 없을 때 읽어야 정확함.
+	Telemetry telemetry() const
+	{
+		Telemetry t{0, 0, replicas_allocated.load(std::memory_order_relaxed), replicas_freed.load(std::memory_order_relaxed),
+					log_reclaims.load(std::memory_order_relaxed)};
+		for (auto &pool : node_pools)
+		{
+			t.log_nodes_allocated += pool.allocated;
+			t.log_nodes_reused += pool.reused;
+		}
+		return t;
+	}
+
+	// 측정 중에도 다른 thread에서 읽을 수 있음
+	uint64_t num_log_reclaims() const
+	{
+		return log_reclaims.load(std::memory_order_relaxed);
+	}
+
+	// 사용 중인 replica들의 Object를 차례로 넘겨준다. apply 중인 thread가 없을 때만 호출.
+	template <typename Func>
+	void visit_objects(Func &&func)
+	{
+		for_each_replica([&func](Combined *comb) { func(static_cast<const Object &>(comb->obj)); });
+	}
+
+	std::optional<Response> apply(const Invoc &invoc, int thread_id)
+	{
+		EpochGuard guard{*this, thread_id};
+		if (Traits::is_read_only(invoc))
+		{
+			return do_read_only(invoc);
+		}
+		if (write_mode == WriteMode::FlatCombining)
+		{
+			return apply_combining(invoc, thread_id);
+		}
+
+		Node *prefer = new_node(invoc, thread_id);
+		if (write_mode == WriteMode::WaitFree)
+			append_wait_free(prefer, thread_id);
+		else
+			append_lock_free(prefer);
+
+		return update_local_obj(*prefer, true);
+	}
+
+private:
+	void append_lock_free(Node *prefer)
+	{
+		while (true)
+		{
+			Node *old_head = head.load(std::memory_order_relaxed);
+			Node *old_next = old_head->next.load(std::memory_order_relaxed);
+			if (old_next != nullptr)
+			{
+				head.compare_exchange_strong(old_head, old_next);
+				continue;
+			}
+
+			prefer->seq.store(old_head->seq + 1, std::memory_order_relaxed);
+			if (true == old_head->next.compare_exchange_strong(old_next, prefer))
+			{
+				head.compare_exchange_strong(old_head, prefer);
+				break;
+			}
+		}
+	}
+
+	// Herlihy의 wait-free universal construction처럼 head 다음 자리에는 (head의 seq + 1) % MAX_THREAD번 thread가
+	// announce해둔 node를 우선 붙인다. 그 thread의 순번이 오면 모든 thread가 같은 node를 제안하므로
+	// 자기 node는 늦어도 MAX_THREAD번의 append 안에 log에 붙음.
+	// seq는 붙은 뒤에 정해지며, head를 옮기기 전에 반드시 기록하므로 head까지의 node는 모두 seq가 있다.
+	void append_wait_free(Node *prefer, int thread_id)
+	{
+		auto &my_slot = announce[thread_id].node;
+		my_slot.store(prefer, std::memory_order_seq_cst);
+
+		while (prefer->seq.load(std::memory_order_acquire) == 0)
+		{
+			Node *old_head = head.load(std::memory_order_acquire);
+			Node *old_next = old_head->next.load(std::memory_order_acquire);
+			if (old_next != nullptr)
+			{
+				advance_head(old_head, old_next);
+				continue;
+			}
+
+			auto &turn = announce[(old_head->seq.load(std::memory_order_relaxed) + 1) % MAX_THREAD].node;
+			Node *candidate = prefer;
+			Node *help = turn.load(std::memory_order_acquire);
+			// help를 읽은 뒤 announce가 그대로라면 주인이 아직 기다리고 있는 것이므로 재활용된 node가 아님.
+			if (help != nullptr && help->seq.load(std::memory_order_acquire) == 0 && turn.load(std::memory_order_acquire) == help)
+				candidate = help;
+
+			if (true == old_head->next.compare_exchange_strong(old_next, candidate))
+				advance_head(old_head, candidate);
+		}
+
+		// helper가 seq만 기록하고 head는 아직 옮기지 않았을 수 있음.
+		// 반환한 뒤에 시작한 read가 head->seq로 이 write를 놓치지 않도록 head를 자기 node까지 옮긴다.
+		const auto my_seq = prefer->seq.load(std::memory_order_acquire);
+		while (true)
+		{
+			Node *old_head = head.load(std::memory_order_acquire);
+			if (old_head->seq.load(std::memory_order_relaxed) >= my_seq)
+				break;
+			advance_head(old_head, old_head->next.load(std::memory_order_acquire));
+		}
+
+		my_slot.store(nullptr, std::memory_order_release);
+	}
+
+	void advance_head(Node *old_head, Node *next)
+	{
+		if (next->seq.load(std::memory_order_acquire) == 0)
+			next->seq.store(old_head->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		head.compare_exchange_strong(old_head, next);
+	}
+
+	// target의 lock을 가진 thread만 부를 수 있음
+	void update_combinded(Combined *target, const std::unique_lock<Combined> &lg)
+	{
+		assert(lg.owns_lock() && lg.mutex() == target);
+		(void)lg;
+		while (true)
+		{
+			auto source = find_replica([target](Combined *comb) {
+				if (comb == target)
+					return false;
+				std::shared_lock<Combined> slg{*comb};
+				if (comb->last_node == nullptr)
+					return false;
+
+				target->obj = comb->obj;
+				target->last_node = comb->last_node;
+				target->applied_seq.store(target->last_node->seq, std::memory_order_release);
+				return true;
+			});
+			if (source != nullptr)
+				return;
+		}
+	}
+
+	std::pair<std::unique_lock<Combined>, Combined &> get_comb()
+	{
+		std::unique_lock<Combined> lg;
+		while (true)
+		{
+			auto comb = find_replica([&lg](Combined *comb) {
+				lg = std::unique_lock<Combined>{*comb, std::try_to_lock};
+				return lg.owns_lock();
+			});
+			if (comb != nullptr)
+			{
+				if (comb->last_node == nullptr)
+				{
+					update_combinded(comb, lg);
+				}
+				return {std::move(lg), *comb};
+			}
+
+			// 모든 replica가 사용 중
+			if (min_replicas < max_replicas && busy_scans.fetch_add(1, std::memory_order_relaxed) + 1 >= GROW_THRESHOLD)
+			{
+				grow();
+			}
+		}
+	}
+
+	// replica를 하나 추가한다. 비어있는 상태로 추가되므로 처음 잡은 thread가 update_combinded로 채움.
+	void grow()
+	{
+		std::unique_lock<std::mutex> lg{resize_lock, std::try_to_lock};
+		if (!lg)
+			return;
+		busy_scans.store(0, std::memory_order_relaxed);
+
+		const auto n = num_active.load(std::memory_order_relaxed);
+		if (n >= max_replicas)
+			return;
+		combined_list[n].store(NUMA_alloc<Combined>(node_of_replica(n)), std::memory_order_relaxed);
+		num_active.store(n + 1, std::memory_order_release);
+		replicas_allocated.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// recycle/compact를 호출한 thread만 호출. 한동안 replica를 못 잡아 헛돈 적이 없으면 마지막 replica를 뺀다.
+	// 빼기 전에 목록을 읽은 thread가 쓰고 있을 수 있으므로 log node와 마찬가지로 epoch 기반으로 해제.
+	void shrink_if_idle()
+	{
+		if (busy_scans.exchange(0, std::memory_order_relaxed) != 0)
+		{
+			idle_periods = 0;
+			return;
+		}
+		if (++idle_periods < SHRINK_PERIODS)
+			return;
+		idle_periods = 0;
+
+		std::unique_lock<std::mutex> lg{resize_lock, std::try_to_lock};
+		if (!lg)
+			return;
+		const auto n = num_active.load(std::memory_order_relaxed);
+		if (n <= min_replicas)
+			return;
+		num_active.store(n - 1, std::memory_order_release);
+		retired_replicas.push_back(RetiredReplica{global_epoch.fetch_add(1), combined_list[n - 1].load(std::memory_order_relaxed)});
+	}
+
+	static int node_of_replica(int index)
+	{
+		return index % NODE_NUM;
+	}
+
+	template <typename Func>
+	void for_each_replica(Func &&func)
+	{
+		const auto n = num_active.load(std::memory_order_acquire);
+		for (auto i = 0; i < n; ++i)
+		{
+			func(combined_list[i].load(std::memory_order_relaxed));
+		}
+	}
+
+	// 호출한 thread와 같은 NUMA node의 replica부터 차례로 pred를 호출하고, 처음 true를 반환한 replica를 돌려준다.
+	template <typename Pred>
+	Combined *find_replica(Pred &&pred)
+	{
+		const auto n = num_active.load(std::memory_order_acquire);
+		const auto local = local_node();
+		for (auto i = local; i < n; i += NODE_NUM)
+		{
+			auto comb = combined_list[i].load(std::memory_order_relaxed);
+			if (pred(comb))
+				return comb;
+		}
+		for (auto i = 0; i < n; ++i)
+		{
+			if (node_of_replica(i) == local)
+				continue;
+			auto comb = combined_list[i].load(std::memory_order_relaxed);
+			if (pred(comb))
+				return comb;
+		}
+		return nullptr;
+	}
+
+	// comb의 lock을 가진 상태에서 호출. until_seq까지의 log를 적용하고 마지막으로 적용한 결과를 반환.
+	Response catch_up(Combined &comb, uint64_t until_seq)
+	{
+		auto &last_node = comb.last_node;
+		auto &last_obj = comb.obj;
+
+		last_node = last_node->next.load(std::memory_order_relaxed);
+		if constexpr (has_apply_batch)
+		{
+			if (until_seq - last_node->seq >= BATCH_THRESHOLD)
+			{
+				// 많이 밀려 있으면 하나씩 적용하지 않고 모아서 한 번에 적용
+				static thread_local std::vector<Node *> pending;
+				static thread_local std::vector<Invoc> invocs;
+				static thread_local std::vector<Response> responses;
+				pending.clear();
+				invocs.clear();
+				while (last_node->seq < until_seq)
+				{
+					pending.push_back(last_node);
+					invocs.push_back(last_node->invoc);
+					last_node = last_node->next.load(std::memory_order_relaxed);
+				}
+				last_obj.apply_batch(invocs, responses);
+				for (size_t i = 0; i < pending.size(); ++i)
+				{
+					pending[i]->response.store(responses[i], std::memory_order_relaxed);
+				}
+			}
+		}
+		while (last_node->seq < until_seq)
+		{
+			last_node->response.store(last_obj.apply(last_node->invoc), std::memory_order_relaxed);
+			last_node = last_node->next.load(std::memory_order_relaxed);
+		}
+
+		auto result = last_obj.apply(last_node->invoc);
+		last_node->response.store(result, std::memory_order_relaxed);
+		comb.applied_seq.store(last_node->seq, std::memory_order_release);
+		return result;
+	}
+
+	std::optional<Response> update_local_obj(const Node &prefer, bool is_write)
+	{
+		std::optional<Response> result;
+		const auto until_seq = prefer.seq.load(std::memory_order_relaxed);
+		{
+			auto &&[lg, comb] = get_comb();
+			assert(lg && "a lock guard didn't get its mutex");
+
+			if (comb.last_node->seq >= until_seq)
+			{
+				// 다른 thread가 이미 이 replica에 적용했음. 그때 기록된 결과를 사용.
+				result = prefer.response.load(std::memory_order_relaxed);
+			}
+			else
+			{
+				result = catch_up(comb, until_seq);
+			}
+		}
+
+		if (is_write)
+		{
+			count_writes(1);
+		}
+
+		return result;
+	}
+
+	// RECYCLE_RATE 번의 쓰기마다 한 thread만 log 정리를 수행
+	void count_writes(uint64_t num)
+	{
+		if (invoke_num.load(std::memory_order_relaxed) < RECYCLE_RATE)
+		{
+			auto prev = invoke_num.fetch_add(num, std::memory_order_relaxed);
+			if (prev < RECYCLE_RATE && RECYCLE_RATE <= prev + num)
+			{
+				if (log_mode == LogMode::Compact)
+					compact();
+				else
+					recycle();
+				if (min_replicas < max_replicas)
+					shrink_if_idle();
+				log_reclaims.fetch_add(1, std::memory_order_relaxed);
+				invoke_num.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// 자기 publication record에 invocation을 올려두고, combiner가 처리해줄 때까지 기다린다.
+	// combiner가 없으면 직접 combiner가 되어 다른 thread들의 것까지 한꺼번에 처리.
+	std::optional<Response> apply_combining(const Invoc &invoc, int thread_id)
+	{
+		auto &record = pub_records[thread_id];
+		record.invoc = invoc;
+		record.state.store(PubRecord::PENDING, std::memory_order_release);
+
+		while (record.state.load(std::memory_order_acquire) != PubRecord::DONE)
+		{
+			if (false == combiner_lock.load(std::memory_order_relaxed) && false == combiner_lock.exchange(true, std::memory_order_acquire))
+			{
+				combine(thread_id);
+				combiner_lock.store(false, std::memory_order_release);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		record.state.store(PubRecord::EMPTY, std::memory_order_relaxed);
+		return record.response;
+	}
+
+	// combiner_lock을 가진 thread만 호출.
+	// 이 mode에서는 combiner만 log에 node를 붙이므로 head가 바뀌지 않는다. 그래서 replica를 head까지 따라잡게 한 뒤
+	// 모아온 invocation들의 결과를 미리 계산하고, 묶음 전체를 한 번의 CAS로 log에 붙임.
+	void combine(int thread_id)
+	{
+		static thread_local std::vector<PubRecord *> batch;
+		batch.clear();
+		for (auto &record : pub_records)
+		{
+			if (record.state.load(std::memory_order_acquire) == PubRecord::PENDING)
+				batch.push_back(&record);
+		}
+		if (batch.empty())
+			return;
+
+		Node *first = nullptr, *last = nullptr;
+		for (auto record : batch)
+		{
+			auto node = new_node(record->invoc, thread_id);
+			if (last == nullptr)
+				first = node;
+			else
+				last->next.store(node, std::memory_order_relaxed);
+			last = node;
+		}
+
+		{
+			auto &&[lg, comb] = get_comb();
+			assert(lg && "a lock guard didn't get its mutex");
+
+			Node *old_head = head.load(std::memory_order_acquire);
+			if (comb.last_node->seq < old_head->seq)
+			{
+				catch_up(comb, old_head->seq);
+			}
+
+			auto seq = old_head->seq.load(std::memory_order_relaxed);
+			auto node = first;
+			for (auto record : batch)
+			{
+				node->seq.store(++seq, std::memory_order_relaxed);
+				record->response = comb.obj.apply(node->invoc);
+				node->response.store(record->response, std::memory_order_relaxed);
+				node = node->next.load(std::memory_order_relaxed);
+			}
+
+			Node *old_next = nullptr;
+			auto linked = old_head->next.compare_exchange_strong(old_next, first);
+			assert(linked && "only the combiner appends to the log");
+			(void)linked;
+			head.compare_exchange_strong(old_head, last);
+
+			comb.last_node = last;
+			comb.applied_seq.store(last->seq, std::memory_order_release);
+		}
+
+		for (auto record : batch)
+		{
+			record->state.store(PubRecord::DONE, std::memory_order_release);
+		}
+		count_writes(batch.size());
+	}
+
+	// 호출 시점의 head 이상까지 적용된 replica에서 lock 없이 읽는다.
+	// 모든 replica가 뒤처져 있거나 수정 중이면 replica 하나를 잡아서 따라잡게 한 뒤 읽음.
+	std::optional<Response> do_read_only(const Invoc &invoc)
+	{
+		auto old_head = head.load(std::memory_order_acquire);
+		const auto min_seq = old_head->seq.load(std::memory_order_relaxed);
+		if constexpr (has_try_read)
+		{
+			std::optional<Response> result;
+			find_replica([&](Combined *comb) {
+				result = comb->try_read(invoc, min_seq);
+				return result.has_value();
+			});
+			if (result)
+				return result;
+		}
+
+		auto &&[lg, comb] = get_comb();
+		assert(lg && "a lock guard didn't get its mutex");
+		if (comb.last_node->seq < min_seq)
+		{
+			catch_up(comb, min_seq);
+		}
+		return comb.obj.apply(invoc);
+	}
+
+	// until_seq 이전의 log node들을 log에서 떼어내고 retire한다.
+	// 떼어낸 node를 아직 보고 있을 수 있는 thread가 있으므로 바로 해제하지 않음.
+	void remove_until_seq(uint64_t until_seq)
+	{
+		auto first = tail->next.load(std::memory_order_relaxed);
+		if (until_seq <= first->seq)
+		{
+			return;
+		}
+
+		auto stop = first;
+		do
+		{
+			stop = stop->next.load(std::memory_order_relaxed);
+		} while (stop->seq < until_seq);
+		tail->next.store(stop, std::memory_order_relaxed);
+
+		retire(first, stop);
+	}
+
+	void recycle()
+	{
+		size_t num_to_remove = RECYCLE_RATE / 2;
+		auto min_seq = tail->next.load(std::memory_order_relaxed)->seq + num_to_remove;
+
+		for_each_replica([min_seq](Combined *comb) {
+			if (comb->last_node == nullptr)
+				return;
+			// comb->last_node를 초기화 하는 thread는 현재 자신 밖에 없으므로 lock 없이 읽어도 안전.
+			if (comb->last_node->seq < min_seq)
+			{
+				std::unique_lock<Combined> lg{*comb};
+
+				// obj는 비우지 않고 남겨둔다. 나중에 update_combinded에서 다른 replica와의 차이만 반영해서 복구함.
+				comb->last_node = nullptr;
+				comb->applied_seq.store(0, std::memory_order_relaxed);
+			}
+		});
+
+		// combine을 초기화하며 진행하는 도중에, 이미 초기화된 comb에 접근해서 조금 뒤에 초기화 될 comb를 복제하면 오류날 수 있음
+		// 다시한번 loop를 돌면서 오래된 seq가 있지는 않는지 확인
+		for_each_replica([&min_seq](Combined *comb) {
+			std::shared_lock<Combined> lg{*comb};
+			if (comb->last_node == nullptr)
+				return;
+
+			if (comb->last_node->seq < min_seq)
+			{
+				min_seq = comb->last_node->seq;
+			}
+		});
+
+		remove_until_seq(min_seq);
+	}
+
+	// replica를 비우지 않고 log를 줄인다.
+	// 많이 뒤처진 replica는 (다른 thread가 쓰고 있지 않다면) 가장 앞선 replica와의 차이만 반영해서 따라잡게 함.
+	// 그래야 거의 쓰이지 않는 replica 때문에 log가 무한히 붙잡히지 않음.
+	void compact()
+	{
+		const auto newest_seq = head.load(std::memory_order_acquire)->seq.load(std::memory_order_relaxed);
+		const uint64_t lag_limit = RECYCLE_RATE;
+
+		auto min_seq = newest_seq;
+		for_each_replica([&](Combined *comb) {
+			auto seq = comb->applied_seq.load(std::memory_order_acquire);
+			// grow()로 막 추가된 비어있는 replica는 log를 붙잡고 있지 않음
+			if (seq == 0)
+				return;
+			if (seq + lag_limit < newest_seq)
+			{
+				std::unique_lock<Combined> lg{*comb, std::try_to_lock};
+				if (lg && comb->last_node != nullptr)
+				{
+					fast_forward(*comb, newest_seq);
+				}
+				seq = comb->applied_seq.load(std::memory_order_acquire);
+				if (seq == 0)
+					return;
+			}
+			if (seq < min_seq)
+			{
+				min_seq = seq;
+			}
+		});
+
+		remove_until_seq(min_seq);
+	}
+
+	// 호출한 thread가 실행 중인 NUMA node
+	static int local_node()
+	{
+		static thread_local int node_id = std::max(numa_node_of_cpu(sched_getcpu()), 0) % NODE_NUM;
+		return node_id;
+	}
+
+	// target의 lock을 가진 상태에서 호출.
+	// 쓰이지 않고 있는 replica 중 가장 앞선 것을 복제하고, 그래도 모자란 만큼만 log를 적용한다.
+	void fast_forward(Combined &target, uint64_t until_seq)
+	{
+		Combined *source = nullptr;
+		for_each_replica([&](Combined *comb) {
+			if (comb == &target)
+				return;
+			if (source == nullptr || source->applied_seq.load(std::memory_order_relaxed) < comb->applied_seq.load(std::memory_order_relaxed))
+				source = comb;
+		});
+
+		if (source != nullptr && target.applied_seq.load(std::memory_order_relaxed) < source->applied_seq.load(std::memory_order_relaxed))
+		{
+			// 서로를 복제하려는 thread끼리 deadlock이 생기지 않도록 기다리지 않음
+			std::shared_lock<Combined> slg{*source, std::try_to_lock};
+			if (slg && source->last_node != nullptr)
+			{
+				target.obj = source->obj;
+				target.last_node = source->last_node;
+				target.applied_seq.store(target.last_node->seq, std::memory_order_release);
+			}
+		}
+
+		// 복제하지 못한 빈 replica는 따라잡을 log가 없음
+		if (target.last_node == nullptr)
+			return;
+		if (target.last_node->seq < until_seq)
+		{
+			catch_up(target, until_seq);
+		}
+	}
+
+	void retire(Node *first, Node *stop)
+	{
+		retired_chains.push_back(RetiredChain{global_epoch.load(std::memory_order_relaxed), first, stop});
+		global_epoch.fetch_add(1);
+
+		auto min_epoch = ULLONG_MAX;
+		for (auto &slot : epoch_slots)
+		{
+			auto e = slot.epoch.load();
+			if (e < min_epoch)
+			{
+				min_epoch = e;
+			}
+		}
+
+		auto removed_it = std::remove_if(retired_chains.begin(), retired_chains.end(), [this, min_epoch](auto &chain) {
+			if (chain.epoch < min_epoch)
+			{
+				free_chain(chain);
+				return true;
+			}
+			return false;
+		});
+		retired_chains.erase(removed_it, retired_chains.end());
+
+		auto removed_replica_it = std::remove_if(retired_replicas.begin(), retired_replicas.end(), [this, min_epoch](auto &retired) {
+			if (retired.epoch < min_epoch)
+			{
+				NUMA_dealloc(retired.comb);
+				replicas_freed.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+			return false;
+		});
+		retired_replicas.erase(removed_replica_it, retired_replicas.end());
+	}
+
+	// 해제 가능해진 chain은 allocator로 돌려주지 않고 통째로 recycled_nodes에 붙인다.
+	// chain의 마지막 node만 바꾸면 되므로 CAS 한 번으로 끝남.
+	void free_chain(const RetiredChain &chain)
+	{
+		auto last = chain.first;
+		while (last->next.load(std::memory_order_relaxed) != chain.stop)
+		{
+			last = last->next.load(std::memory_order_relaxed);
+		}
+
+		auto top = recycled_nodes.load(std::memory_order_relaxed);
+		do
+		{
+			last->next.store(top, std::memory_order_relaxed);
+		} while (false == recycled_nodes.compare_exchange_weak(top, chain.first, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	// 자기 pool에서 꺼내 쓰고, 비어 있으면 재활용된 node들을 전부 가져온다. 그것도 없을 때만 새로 할당.
+	// 전부 가져오는 것(exchange)만 있으므로 ABA 문제가 없음.
+	Node *new_node(const Invoc &invoc, int thread_id)
+	{
+		auto &pool = node_pools[thread_id];
+		auto &free_list = pool.free_list;
+		if (free_list == nullptr)
+		{
+			free_list = recycled_nodes.exchange(nullptr, std::memory_order_acquire);
+			if (free_list == nullptr)
+			{
+				++pool.allocated;
+				return new Node(invoc);
+			}
+		}
+		++pool.reused;
+
+		auto node = free_list;
+		free_list = node->next.load(std::memory_order_relaxed);
+		node->invoc = invoc;
+		node->seq.store(0, std::memory_order_relaxed);
+		node->next.store(nullptr, std::memory_order_relaxed);
+		node->response.store(Response{}, std::memory_order_relaxed);
+		return node;
+	}
+
+	static void delete_list(Node *cur)
+	{
+		while (cur != nullptr)
+		{
+			Node *del = cur;
+			cur = cur->next.load(std::memory_order_relaxed);
+			delete del;
+		}
+	}
+
+	// 가장 최근 Node
+	alignas(64) std::atomic<Node *> head;
+	// 앞의 num_active개만 사용. 줄일 때 뺀 replica의 pointer는 다시 늘릴 때까지 남아 있음.
+	std::array<std::atomic<Combined *>, MAX_REPLICA> combined_list{};
+	// 가장 오래된 Node
+	Node *tail;
+	const int min_replicas;
+	const int max_replicas;
+	std::atomic_int num_active;
+	alignas(64) std::atomic_uint64_t busy_scans{0};
+	std::mutex resize_lock;
+	// shrink_if_idle을 호출하는 thread만 사용
+	int idle_periods = 0;
+	alignas(64) std::atomic_ullong invoke_num;
+	const LogMode log_mode;
+	const WriteMode write_mode;
+
+	std::array<PubRecord, MAX_THREAD> pub_records;
+	std::array<AnnounceSlot, MAX_THREAD> announce;
+	alignas(64) std::atomic_bool combiner_lock;
+
+	std::atomic_ullong global_epoch;
+	std::array<EpochSlot, MAX_THREAD> epoch_slots;
+	// recycle/compact는 한 번에 한 thread만 호출하므로 lock 없이 사용
+	std::vector<RetiredChain> retired_chains;
+	std::vector<RetiredReplica> retired_replicas;
+
+	std::array<NodePool, MAX_THREAD> node_pools;
+	alignas(64) std::atomic<Node *> recycled_nodes{nullptr};
+
+	alignas(64) std::atomic_uint64_t replicas_allocated{0};
+	std::atomic_uint64_t replicas_freed{0};
+	std::atomic_uint64_t log_reclaims{0};
+};
+
+#endif /* D8A61E0B_3C4F_4E0A_9F2D_6B1C7E52A9F4 */
@@ -0,0 +1,588 @@
+#ifndef A3F09C52_71D8_4B6E_8E41_2C5D0F9B7A13
+#define A3F09C52_71D8_4B6E_8E41_2C5D0F9B7A13
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "arena.h"
+
+inline unsigned long fast_rand(void)
+{ //period 2^96-1
+	static thread_local unsigned long x = 123456789, y = 362436069, z = 521288629;
+	unsigned long t;
+	x ^= x << 16;
+	x ^= x >> 5;
+	x ^= x << 1;
+
+	t = x;
+	x = y;
+	y = z;
+	z = t ^ x ^ y;
+
+	return z;
+}
+
+constexpr int MAXHEIGHT = 10;
+// next는 실제 높이만큼만 할당하는 가변 길이 tower. 높이 1인 node는 16 byte이고,
+// arena가 16 byte 단위로 배치하므로 key와 next[0]은 항상 같은 cache line에 있다.
+class SLNODE
+{
+public:
+	int key;
+	int height;
+	SLNODE *next[];
+
+	SLNODE(int x, int h) : key{x}, height{h}
+	{
+		for (auto i = 0; i < h; ++i)
+			next[i] = nullptr;
+	}
+
+	// 높이 height인 node가 차지하는 byte 수
+	static constexpr size_t bytes_for(int height)
+	{
+		return sizeof(SLNODE) + height * sizeof(SLNODE *);
+	}
+};
+
+class SKLIST
+{
+	struct CopyingInfo
+	{
+		const SLNODE *org;
+		SLNODE *curr;
+		int level;
+
+		CopyingInfo() {}
+		CopyingInfo(const SLNODE *org, SLNODE *curr, int level) : org{org}, curr{curr}, level{level} {}
+	};
+
+	// replica마다 따로 두는 node arena. 해제된 node도 메모리는 arena에 남아있으므로
+	// lock 없이 읽는 reader가 방금 빠진 node를 따라가도 해제된 메모리를 보지 않는다.
+	// head/tail도 arena에서 받으므로 arena와 함께 옮겨진다.
+	TowerArena<SLNODE, MAXHEIGHT> arena;
+	SLNODE *head, *tail;
+	int size = 0;
+	// 마지막으로 찾은 key와 그때의 preds (finger). 다음 key가 그보다 크거나 같으면 head 대신 finger에서 시작한다.
+	// replica는 한 번에 한 thread만 수정하므로 replica마다 하나씩 두면 그 thread의 finger가 됨.
+	// lock 없이 읽는 Try* 함수들은 쓰지 않는다.
+	SLNODE *finger[MAXHEIGHT];
+	int finger_key;
+
+public:
+	SKLIST()
+	{
+		InitSentinels();
+		ResetFinger();
+	}
+	SKLIST(const SKLIST &other) : SKLIST()
+	{
+		copy_and_link(other, *this);
+	}
+	SKLIST(SKLIST &&other) : arena{std::move(other.arena)}, head{other.head}, tail{other.tail}, size{other.size}
+	{
+		other.size = 0;
+		other.InitSentinels();
+		other.ResetFinger();
+		ResetFinger();
+	}
+
+	SKLIST &operator=(const SKLIST &other)
+	{
+		// 기존 node들을 최대한 재사용하며 other와 같은 내용으로 맞춤
+		copy_and_link(other, *this);
+		return *this;
+	}
+	SKLIST &operator=(SKLIST &&other)
+	{
+		std::swap(arena, other.arena);
+		std::swap(head, other.head);
+		std::swap(tail, other.tail);
+		std::swap(size, other.size);
+		other.Init();
+		ResetFinger();
+		return *this;
+	}
+
+	// from의 내용을 to에 반영한다. to가 이미 가지고 있는 key의 node는 그대로 재사용하고,
+	// 없어진 key의 node만 해제, 새로 생긴 key의 node만 할당하므로 할당/해제 비용은 바뀐 node 수에 비례한다.
+	// 각 level의 마지막 node를 기억해두고 bottom level 순서대로 다시 이어주기 때문에 원본 node -> 사본 node 사이의 map이 필요 없다.
+	static void copy_and_link(const SKLIST &from, SKLIST &to)
+	{
+		SLNODE *lasts[MAXHEIGHT];
+		for (auto &p : lasts)
+			p = to.head;
+
+		SLNODE *to_node = to.head->next[0];
+		const SLNODE *from_node = from.head->next[0];
+		while (from_node != from.tail)
+		{
+			while (to_node != to.tail && to_node->key < from_node->key)
+			{
+				auto del = to_node;
+				to_node = to_node->next[0];
+				to.DeleteNode(del);
+			}
+
+			SLNODE *node;
+			if (to_node != to.tail && to_node->key == from_node->key)
+			{
+				node = to_node;
+				to_node = to_node->next[0];
+			}
+			else
+			{
+				node = to.NewNode(from_node->key, from_node->height);
+			}
+
+			for (auto i = 0; i < node->height; ++i)
+			{
+				lasts[i]->next[i] = node;
+				lasts[i] = node;
+			}
+			from_node = from_node->next[0];
+		}
+
+		while (to_node != to.tail)
+		{
+			auto del = to_node;
+			to_node = to_node->next[0];
+			to.DeleteNode(del);
+		}
+		for (auto i = 0; i < MAXHEIGHT; ++i)
+		{
+			lasts[i]->next[i] = to.tail;
+		}
+		to.ResetFinger();
+	}
+
+	// node를 하나씩 따라가며 해제하지 않고 arena를 통째로 되돌리므로 크기와 상관없이 O(1).
+	// head/tail은 reset 뒤에 가장 먼저 다시 할당하므로 같은 자리를 그대로 받는다.
+	void Init()
+	{
+		arena.reset();
+		size = 0;
+		InitSentinels();
+		ResetFinger();
+	}
+	// finger search. key가 직전에 찾은 key보다 작으면 head에서 다시 시작한다.
+	// finger의 다음 node가 key보다 작지 않은 가장 낮은 level까지만 올라가서 거기서부터 내려오므로,
+	// 정렬된 log를 따라잡거나 가까운 key를 연달아 찾을 때 O(log n) 대신 key 거리 d에 대해 O(log d)만 걷는다.
+	void Find(int key, SLNODE *preds[MAXHEIGHT], SLNODE *currs[MAXHEIGHT])
+	{
+		if (key < finger_key)
+			ResetFinger();
+		auto top = 0;
+		while (top < MAXHEIGHT - 1 && finger[top]->next[top]->key < key)
+			++top;
+		// top 위의 level은 finger가 그대로 답
+		for (auto cl = MAXHEIGHT - 1; top < cl; --cl)
+		{
+			preds[cl] = finger[cl];
+			currs[cl] = finger[cl]->next[cl];
+		}
+		for (auto cl = top; 0 <= cl; --cl)
+		{
+			// finger와 위 level에서 내려온 pred 중 더 가까운 쪽에서 시작
+			if (top == cl || preds[cl + 1]->key < finger[cl]->key)
+				preds[cl] = finger[cl];
+			else
+				preds[cl] = preds[cl + 1];
+			currs[cl] = preds[cl]->next[cl];
+			while (currs[cl]->key < key)
+			{
+				preds[cl] = currs[cl];
+				currs[cl] = currs[cl]->next[cl];
+			}
+		}
+		std::copy(preds, preds + MAXHEIGHT, finger);
+		finger_key = key;
+	}
+
+	bool Add(int key)
+	{
+		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
+
+		Find(key, preds, currs);
+
+		if (key == currs[0]->key)
+		{
+			return false;
+		}
+		else
+		{
+			Link(key, preds, currs);
+			return true;
+		}
+	}
+	bool Remove(int key)
+	{
+		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
+
+		Find(key, preds, currs);
+
+		if (key == currs[0]->key)
+		{
+			Unlink(preds, currs);
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// key 오름차순으로 정렬된 keys를 한 번의 sweep으로 처리한다. 각 key에 대해 decide(index, 현재 존재 여부)가
+	// 적용 후 존재 여부를 돌려주면 그에 맞게 넣거나 뺀다.
+	// Find가 직전 key의 finger에서 이어서 찾으므로 각 level은 처음부터 끝까지 많아야 한 번만 지나가게 됨.
+	template <typename Decide>
+	void ApplySorted(const std::vector<int> &keys, Decide &&decide)
+	{
+		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
+		for (size_t idx = 0; idx < keys.size(); ++idx)
+		{
+			const auto key = keys[idx];
+			Find(key, preds, currs);
+
+			const bool was_present = key == currs[0]->key;
+			const bool present = decide(idx, was_present);
+			if (present && !was_present)
+				Link(key, preds, currs);
+			else if (!present && was_present)
+				Unlink(preds, currs);
+		}
+	}
+
+	bool Contains(int key)
+	{
+		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
+		Find(key, preds, currs);
+		if (key == currs[0]->key)
+		{
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// [lo, hi)의 key를 작은 것부터 최대 limit개까지 visit(key)로 넘기고 넘긴 개수를 반환한다.
+	template <typename Visit>
+	int VisitRange(int lo, int hi, int limit, Visit &&visit)
+	{
+		SLNODE *preds[MAXHEIGHT], *currs[MAXHEIGHT];
+		Find(lo, preds, currs);
+		auto count = 0;
+		for (auto curr = currs[0]; count < limit && curr->key < hi; curr = curr->next[0])
+		{
+			visit(curr->key);
+			++count;
+		}
+		return count;
+	}
+
+	// [lo, hi)에 있는 key 수
+	int RangeCount(int lo, int hi)
+	{
+		return VisitRange(lo, hi, INT_MAX, [](int) {});
+	}
+
+	// [lo, hi)의 key를 작은 것부터 최대 capacity개까지 out에 채우고 채운 개수를 반환한다.
+	// capacity개를 꽉 채웠으면 뒤에 더 있을 수 있으므로 마지막 key + 1부터 다시 부르면 이어서 받을 수 있음.
+	int RangeScan(int lo, int hi, int *out, int capacity)
+	{
+		return VisitRange(lo, hi, capacity, [&out](int key) { *out++ = key; });
+	}
+
+	// 다른 thread가 수정하고 있을 수도 있는 상태에서 lock 없이 찾는다.
+	// 중간에 이상한 경로(재사용된 node, 끊긴 link)로 빠지면 nullopt를 반환하고, 결과가 유효한지는 호출자가 version으로 확인해야 함.
+	std::optional<bool> TryContains(int key) const
+	{
+		auto steps = 0;
+		const auto curr = TryLowerBound(key, steps);
+		if (curr == nullptr)
+			return std::nullopt;
+		return key == curr->key;
+	}
+
+	// VisitRange를 lock 없이 수행. nullopt이면 그 사이에 넘긴 key는 버려야 하고, 결과가 유효한지는 TryContains처럼 호출자가 확인.
+	template <typename Visit>
+	std::optional<int> TryVisitRange(int lo, int hi, int limit, Visit &&visit) const
+	{
+		auto steps = 0;
+		auto curr = TryLowerBound(lo, steps);
+		if (curr == nullptr)
+			return std::nullopt;
+		auto count = 0;
+		while (count < limit && curr->key < hi)
+		{
+			if (++steps > max_try_steps())
+				return std::nullopt;
+			visit(curr->key);
+			++count;
+			curr = curr->next[0];
+			if (curr == nullptr)
+				return std::nullopt;
+		}
+		return count;
+	}
+
+	std::optional<int> TryRangeCount(int lo, int hi) const
+	{
+		return TryVisitRange(lo, hi, INT_MAX, [](int) {});
+	}
+
+	std::optional<int> TryRangeScan(int lo, int hi, int *out, int capacity) const
+	{
+		return TryVisitRange(lo, hi, capacity, [&out](int key) { *out++ = key; });
+	}
+
+	// 이 list가 지금까지 확보한 node 수 (사용 중 + 재사용 대기)
+	size_t allocated_nodes() const
+	{
+		return arena.capacity();
+	}
+
+	void display20()
+	{
+		int c = 20;
+		SLNODE *p = head->next[0];
+		while (p != tail)
+		{
+			std::cout << p->key << ", ";
+			p = p->next[0];
+			c--;
+			if (c == 0)
+				break;
+		}
+		std::cout << std::endl;
+	}
+
+private:
+	// node를 한꺼번에 해제하거나 통째로 바꾼 뒤에는 finger가 가리키던 node가 없을 수 있으므로 head로 되돌림
+	void ResetFinger()
+	{
+		for (auto &p : finger)
+			p = head;
+		finger_key = head->key;
+	}
+
+	// lock 없이 읽을 때 따라갈 link 수의 한도. 이보다 많이 걸으면 수정 중인 list에서 고리에 빠졌다고 봄
+	int max_try_steps() const
+	{
+		return size + MAXHEIGHT + 1;
+	}
+
+	// key보다 작지 않은 첫 node. 이상한 경로로 빠지면 nullptr. steps에 따라간 link 수를 더함
+	const SLNODE *TryLowerBound(int key, int &steps) const
+	{
+		const SLNODE *pred = head;
+		const SLNODE *curr = nullptr;
+		for (auto cl = MAXHEIGHT - 1; 0 <= cl; --cl)
+		{
+			curr = pred->next[cl];
+			while (curr != nullptr && curr->key < key)
+			{
+				if (++steps > max_try_steps())
+					return nullptr;
+				// 재사용된 node는 cl층까지 tower가 없을 수 있음. 자리마다 높이가 고정이므로 height는 믿을 수 있다.
+				if (curr->height <= cl)
+					return nullptr;
+				pred = curr;
+				curr = curr->next[cl];
+			}
+			if (curr == nullptr)
+				return nullptr;
+		}
+		return curr;
+	}
+
+	void InitSentinels()
+	{
+		head = arena.alloc(MAXHEIGHT, 0x80000000, MAXHEIGHT);
+		tail = arena.alloc(MAXHEIGHT, 0x7FFFFFFF, MAXHEIGHT);
+		for (auto i = 0; i < MAXHEIGHT; ++i)
+			head->next[i] = tail;
+	}
+
+	void Link(int key, SLNODE *preds[MAXHEIGHT], SLNODE *currs[MAXHEIGHT])
+	{
+		int height = 1;
+		while (fast_rand() % 2 == 0)
+		{
+			height++;
+			if (MAXHEIGHT == height)
+				break;
+		}
+		SLNODE *node = NewNode(key, height);
+		for (int i = 0; i < height; ++i)
+		{
+			preds[i]->next[i] = node;
+			node->next[i] = currs[i];
+		}
+	}
+	void Unlink(SLNODE *preds[MAXHEIGHT], SLNODE *currs[MAXHEIGHT])
+	{
+		for (int i = 0; i < currs[0]->height; ++i)
+		{
+			preds[i]->next[i] = currs[i]->next[i];
+		}
+		DeleteNode(currs[0]);
+	}
+
+	SLNODE *NewNode(int key, int height)
+	{
+		++size;
+		return arena.alloc(height, key, height);
+	}
+	void DeleteNode(SLNODE *node)
+	{
+		--size;
+		arena.free(node, node->height);
+	}
+};
+
+enum class Func
+{
+	None,
+	Add,
+	Remove,
+	Contains,
+	// [arg, hi)에 있는 key 수
+	RangeCount,
+	// [arg, hi)의 key를 작은 것부터 최대 capacity개까지 out에 채움. 결과는 채운 개수
+	RangeScan,
+};
+
+struct Invoc
+{
+	Func func;
+	int arg;
+	// 아래는 range 연산에서만 사용. 읽기 전용이라 log에는 들어가지 않으므로 out은 호출한 thread의 buffer를 가리킴
+	int hi;
+	int capacity;
+	int *out;
+
+	Invoc(Func func = Func::None, int arg = 0) : func{func}, arg{arg}, hi{0}, capacity{0}, out{nullptr} {}
+	Invoc(Func func, int lo, int hi, int *out = nullptr, int capacity = 0) : func{func}, arg{lo}, hi{hi}, capacity{capacity}, out{out} {}
+
+	bool is_read_only() const
+	{
+		return func == Func::Contains || func == Func::RangeCount || func == Func::RangeScan;
+	}
+};
+
+using Response = int;
+
+// OLFUniversal의 replica로 쓰이는 순차 skiplist set
+struct SkiplistObject
+{
+	SKLIST container;
+
+	Response apply(const Invoc &invoc)
+	{
+		switch (invoc.func)
+		{
+		case Func::Add:
+			return container.Add(invoc.arg);
+		case Func::Remove:
+			return container.Remove(invoc.arg);
+		case Func::Contains:
+			return container.Contains(invoc.arg);
+		case Func::RangeCount:
+			return container.RangeCount(invoc.arg, invoc.hi);
+		case Func::RangeScan:
+			return container.RangeScan(invoc.arg, invoc.hi, invoc.out, invoc.capacity);
+		default:
+			std::cerr << "Unknown Method" << std::endl;
+			return 0;
+		}
+	}
+
+	// 읽기 전용 invocation을 lock 없이 수행. 결과를 믿을 수 있는지는 호출자가 확인.
+	std::optional<Response> try_read(const Invoc &invoc) const
+	{
+		switch (invoc.func)
+		{
+		case Func::Contains:
+		{
+			auto found = container.TryContains(invoc.arg);
+			if (!found)
+				return std::nullopt;
+			return *found;
+		}
+		// scan이 길어도 writer를 막지 않음. 도중에 replica가 바뀌면 호출자가 다른 replica에서 다시 시도
+		case Func::RangeCount:
+			return container.TryRangeCount(invoc.arg, invoc.hi);
+		case Func::RangeScan:
+			return container.TryRangeScan(invoc.arg, invoc.hi, invoc.out, invoc.capacity);
+		default:
+			return std::nullopt;
+		}
+	}
+
+	// 여러 invocation을 한꺼번에 적용하고 각각의 결과를 responses에 채운다.
+	// key별로 정렬한 뒤 같은 key의 invocation들은 처음 존재 여부에서부터 결과만 계산하고
+	// (Add-Remove 쌍은 상쇄됨) 최종 상태만 container에 한 번의 sweep으로 반영.
+	void apply_batch(const std::vector<Invoc> &invocs, std::vector<Response> &responses)
+	{
+		static thread_local std::vector<size_t> order;
+		static thread_local std::vector<size_t> group_begin;
+		static thread_local std::vector<int> keys;
+
+		order.resize(invocs.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&invocs](size_t a, size_t b) { return invocs[a].arg < invocs[b].arg; });
+
+		group_begin.clear();
+		keys.clear();
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			const auto key = invocs[order[i]].arg;
+			if (keys.empty() || keys.back() != key)
+			{
+				keys.push_back(key);
+				group_begin.push_back(i);
+			}
+		}
+		group_begin.push_back(order.size());
+
+		responses.resize(invocs.size());
+		container.ApplySorted(keys, [&](size_t group, bool present) {
+			for (auto i = group_begin[group]; i < group_begin[group + 1]; ++i)
+			{
+				const auto idx = order[i];
+				switch (invocs[idx].func)
+				{
+				case Func::Add:
+					responses[idx] = !present;
+					present = true;
+					break;
+				case Func::Remove:
+					responses[idx] = present;
+					present = false;
+					break;
+				case Func::Contains:
+					responses[idx] = present;
+					break;
+				default:
+					responses[idx] = 0;
+					break;
+				}
+			}
+			return present;
+		});
+	}
+
+	void init()
+	{
+		container.Init();
+	}
+};
+
+#endif /* A3F09C52_71D8_4B6E_8E41_2C5D0F9B7A13 */
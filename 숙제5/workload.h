@@ -0,0 +1,296 @@
+#ifndef F41A7C63_8E25_4B9D_9C07_2A6D5E3B18F0
+#define F41A7C63_8E25_4B9D_9C07_2A6D5E3B18F0
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "olf_universal.h"
+#include "skiplist.h"
+#include "key_space.h"
+#include "topology.h"
+
+// IPP_HW5의 측정 조건. 모두 실행할 때 command line으로 정하므로 조건을 바꿔도 다시 build할 필요가 없다.
+
+enum class OutputFormat
+{
+	Text,
+	Csv,
+	Json,
+};
+
+// key 범위와 분포는 KeySpace에서 물려받음
+struct Workload : KeySpace
+{
+	// 연산 비율 (%). 합은 100
+	int read = 30;
+	int add = 35;
+	int remove = 35;
+	// range 연산의 비율 (%). 반은 RangeCount, 반은 RangeScan
+	int range = 0;
+	// range 연산이 덮는 key 구간 [key, key + range_len)의 길이
+	int range_len = 100;
+	// RangeScan이 한 번에 받는 최대 key 수. thread마다 이 크기의 buffer를 둠
+	int scan_limit = 64;
+	// 측정 전에 미리 넣어둘 key 개수
+	int prefill = 0;
+	// 전체 연산 수를 thread들이 나눠서 수행. duration_ms가 0보다 크면 무시하고 시간만큼 수행
+	long long num_ops = 4000000;
+	int duration_ms = 0;
+	std::vector<int> threads;
+	// 측정 thread를 고정하는 방법. 기본은 실행할 때마다 같은 CPU에 놓이도록 compact
+	PinPolicy pin = PinPolicy::Compact;
+	std::vector<WriteMode> write_modes{WriteMode::LockFree};
+	LogMode log_mode = LogMode::Recycle;
+	// 0이면 replica 1개로 시작해서 thread 수까지 자동으로 조절, 아니면 그 개수로 고정
+	int replicas = 0;
+	OutputFormat format = OutputFormat::Text;
+	// RSS를 읽는 간격. 0이면 측정 구간의 최댓값과 끝난 뒤의 값만 기록
+	int rss_interval_ms = 10;
+	// 비어있지 않으면 sampling한 RSS를 이 파일에 CSV로 덧붙임
+	std::string rss_log;
+	// 연산 기록을 남기고 측정이 끝날 때마다 linearizability를 검사. 기록 buffer도 RSS에 포함됨
+	bool check = false;
+	// --duration과 같이 쓸 때 thread마다 기록할 수 있는 연산 수
+	size_t history_capacity = 1 << 18;
+};
+
+inline const char *to_string(WriteMode mode)
+{
+	switch (mode)
+	{
+	case WriteMode::LockFree:
+		return "LockFree";
+	case WriteMode::FlatCombining:
+		return "FlatCombining";
+	case WriteMode::WaitFree:
+		return "WaitFree";
+	}
+	return "Unknown";
+}
+
+inline const char *to_string(LogMode mode)
+{
+	return mode == LogMode::Compact ? "Compact" : "Recycle";
+}
+
+// thread마다 하나씩 두고 다음 연산과 key를 만든다. 난수 상태를 thread별로 따로 가지므로 공유 메모리에 쓰지 않음.
+class OpGenerator : public KeyGenerator
+{
+public:
+	OpGenerator(const Workload &workload, int thread_id) : KeyGenerator{workload, thread_id}, workload{workload}, scan_buffer(workload.scan_limit) {}
+
+	// RangeScan의 결과는 다음 next()를 부르기 전까지 scan_buffer에 남아있음
+	Invoc next()
+	{
+		const auto ticket = static_cast<int>(next_rand() % 100);
+		const auto key = next_key();
+		if (ticket < workload.read)
+			return Invoc(Func::Contains, key);
+		if (ticket < workload.read + workload.add)
+			return Invoc(Func::Add, key);
+		if (ticket < workload.read + workload.add + workload.remove)
+			return Invoc(Func::Remove, key);
+		const auto hi = key > INT_MAX - workload.range_len ? INT_MAX : key + workload.range_len;
+		if (ticket % 2 == 0)
+			return Invoc(Func::RangeCount, key, hi);
+		return Invoc(Func::RangeScan, key, hi, scan_buffer.data(), workload.scan_limit);
+	}
+
+private:
+	const Workload &workload;
+	std::vector<int> scan_buffer;
+};
+
+inline void print_usage(const char *prog)
+{
+	fprintf(stderr,
+			"usage: %s [lf|fc|wf|compare] [options]\n"
+			"  --mode=lf,fc,wf          write modes to measure (compare = all)\n"
+			"  --log=recycle|compact    log reclamation mode\n"
+			"  --replicas=N             fixed replica count, 0 = adaptive (default)\n"
+			"  --read=P                 P%% contains, the rest split between add/remove\n"
+			"  --mix=R:A:D[:G]          contains:add:remove[:range] percentages\n"
+			"  --range-len=N            range queries cover [key, key + N) (default 100)\n"
+			"  --scan-limit=N           RangeScan returns at most N keys per call (default 64)\n"
+			"  --keys=N                 key range (default 1000)\n"
+			"  --dist=uniform|zipf|hotspot\n"
+			"  --zipf=THETA             zipf skew (default 0.99)\n"
+			"  --hot=K:O                hotspot: K%% of keys get O%% of operations (default 20:80)\n"
+			"  --prefill=N              insert N distinct keys before measuring\n"
+			"  --ops=N                  total operations per run (default 4000000)\n"
+			"  --duration=MS            run for MS milliseconds instead of a fixed op count\n"
+			"  --threads=1,2,4          thread counts (default 1,2,4,...,%d)\n"
+			"  --pin=none|compact|scatter|smt  thread placement (default compact)\n"
+			"  --format=text|csv|json\n"
+			"  --rss-interval=MS        RSS sampling interval (default 10, 0 = peak only)\n"
+			"  --rss-log=FILE           append sampled RSS with log reclaim counts to FILE\n"
+			"  --check                  record the history and check linearizability after each run (range queries are not recorded)\n"
+			"  --history=N              with --duration, per-thread history capacity (default 262144)\n",
+			prog, MAX_THREAD);
+}
+
+inline bool parse_write_modes(const std::string &value, std::vector<WriteMode> &modes)
+{
+	modes.clear();
+	for (auto &token : split(value, ','))
+	{
+		if (token == "lf")
+			modes.push_back(WriteMode::LockFree);
+		else if (token == "fc")
+			modes.push_back(WriteMode::FlatCombining);
+		else if (token == "wf")
+			modes.push_back(WriteMode::WaitFree);
+		else if (token == "compare")
+			modes.insert(modes.end(), {WriteMode::LockFree, WriteMode::FlatCombining, WriteMode::WaitFree});
+		else
+			return false;
+	}
+	return !modes.empty();
+}
+
+// 잘못된 인자가 있으면 사용법을 출력하고 종료한다.
+inline Workload parse_workload(int argc, char *argv[])
+{
+	Workload workload;
+	auto fail = [argv](const std::string &arg) {
+		fprintf(stderr, "invalid argument: %s\n", arg.c_str());
+		print_usage(argv[0]);
+		exit(-1);
+	};
+
+	for (auto i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "-h" || arg == "--help")
+		{
+			print_usage(argv[0]);
+			exit(0);
+		}
+		if (arg == "--check")
+		{
+			workload.check = true;
+			continue;
+		}
+		// 예전처럼 첫 인자로 mode만 주는 것도 허용
+		if (arg.compare(0, 2, "--") != 0)
+		{
+			if (!parse_write_modes(arg, workload.write_modes))
+				fail(arg);
+			continue;
+		}
+
+		const auto eq = arg.find('=');
+		if (eq == std::string::npos)
+			fail(arg);
+		const auto name = arg.substr(2, eq - 2);
+		const auto value = arg.substr(eq + 1);
+		bool ok;
+
+		if (name == "mode")
+		{
+			if (!parse_write_modes(value, workload.write_modes))
+				fail(arg);
+		}
+		else if (name == "log")
+		{
+			if (value == "recycle")
+				workload.log_mode = LogMode::Recycle;
+			else if (value == "compact")
+				workload.log_mode = LogMode::Compact;
+			else
+				fail(arg);
+		}
+		else if (name == "replicas")
+			workload.replicas = std::atoi(value.c_str());
+		else if (name == "read")
+		{
+			workload.read = std::atoi(value.c_str());
+			workload.add = (100 - workload.read - workload.range) / 2;
+			workload.remove = 100 - workload.read - workload.range - workload.add;
+		}
+		else if (name == "mix")
+		{
+			const auto tokens = split(value, ':');
+			if (tokens.size() != 3 && tokens.size() != 4)
+				fail(arg);
+			workload.read = std::atoi(tokens[0].c_str());
+			workload.add = std::atoi(tokens[1].c_str());
+			workload.remove = std::atoi(tokens[2].c_str());
+			workload.range = tokens.size() == 4 ? std::atoi(tokens[3].c_str()) : 0;
+		}
+		else if (name == "range-len")
+			workload.range_len = std::atoi(value.c_str());
+		else if (name == "scan-limit")
+			workload.scan_limit = std::atoi(value.c_str());
+		else if (parse_key_option(name, value, workload, ok))
+		{
+			if (!ok)
+				fail(arg);
+		}
+		else if (name == "prefill")
+			workload.prefill = std::atoi(value.c_str());
+		else if (name == "ops")
+			workload.num_ops = std::atoll(value.c_str());
+		else if (name == "duration")
+			workload.duration_ms = std::atoi(value.c_str());
+		else if (name == "threads")
+		{
+			for (auto &token : split(value, ','))
+				workload.threads.push_back(std::atoi(token.c_str()));
+		}
+		else if (name == "pin")
+		{
+			if (!parse_pin_policy(value, workload.pin))
+				fail(arg);
+		}
+		else if (name == "rss-interval")
+			workload.rss_interval_ms = std::atoi(value.c_str());
+		else if (name == "rss-log")
+			workload.rss_log = value;
+		else if (name == "history")
+			workload.history_capacity = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "format")
+		{
+			if (value == "text")
+				workload.format = OutputFormat::Text;
+			else if (value == "csv")
+				workload.format = OutputFormat::Csv;
+			else if (value == "json")
+				workload.format = OutputFormat::Json;
+			else
+				fail(arg);
+		}
+		else
+			fail(arg);
+	}
+
+	if (workload.threads.empty())
+	{
+		for (auto n = 1; n <= MAX_THREAD; n *= 2)
+			workload.threads.push_back(n);
+	}
+	for (auto n : workload.threads)
+	{
+		if (n < 1 || MAX_THREAD < n)
+			fail("--threads");
+	}
+	if (workload.read < 0 || workload.add < 0 || workload.remove < 0 || workload.range < 0 ||
+		workload.read + workload.add + workload.remove + workload.range != 100)
+		fail("--mix");
+	if (workload.range_len < 1 || workload.scan_limit < 1)
+		fail("--range-len/--scan-limit");
+	if (workload.prefill < 0 || workload.key_range < workload.prefill)
+		fail("--keys/--prefill");
+	if (workload.replicas < 0 || MAX_REPLICA < workload.replicas)
+		fail("--replicas");
+	if (workload.history_capacity < 1)
+		fail("--history");
+	if (!workload.prepare())
+		fail("--keys/--dist/--zipf/--hot");
+	return workload;
+}
+
+#endif /* F41A7C63_8E25_4B9D_9C07_2A6D5E3B18F0 */
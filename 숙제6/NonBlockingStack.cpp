@@ -10,8 +10,11 @@
 #include <chrono>
 #include <memory>
 #include <stack>
+#include <string>
 #include <numa.h>
-#include "numa_util.h"
+#include "ed_stack.h"
+#include "ws_deque.h"
+#include "latency_histogram.h"
 
 using namespace std;
 
@@ -34,345 +37,178 @@ unsigned long fast_rand(void)
 	return z;
 }
 
-struct Node
-{
-public:
-	int key;
-	atomic<Node *> next;
-
-	Node() : next{nullptr} {}
-	Node(int key) : key{key}, next{nullptr} {}
-	~Node() {}
-};
-
-bool CAS(atomic<Node *> &ptr, Node *old_value, Node *new_value)
-{
-	return ptr.compare_exchange_strong(old_value, new_value);
-}
-
-thread_local unsigned exSize = 1;
-constexpr unsigned MAX_THREAD = 64;
+// Lock-Free Elimination BackOff Stack
 
-static unsigned NODE_NUM = numa_num_configured_nodes();
-static unsigned CPU_NUM = numa_num_configured_cpus();
-static atomic_uint tid_counter{0};
-static thread_local unsigned tid = tid_counter.fetch_add(1, memory_order_relaxed);
-unsigned get_node_id(unsigned tid)
+enum StackOp
 {
-	auto core_per_node = (CPU_NUM / 2) / NODE_NUM;
-	return (tid / core_per_node) % NODE_NUM;
-}
+	OP_PUSH,
+	OP_POP,
+	NUM_STACK_OP
+};
+const char *const STACK_OP_NAMES[NUM_STACK_OP] = {"push", "pop "};
+OpLatency<NUM_STACK_OP> latencies[MAX_THREAD];
 
-constexpr unsigned POP_WAIT_TIME = 100;
+ThreadPlacement placements[MAX_THREAD];
+EliminationPolicy eliminations[MAX_THREAD];
 
-struct EliminationSlot
+// "    Elimination : 12.5% hit (1250 / 10000),  Timeouts : 8000,  Collisions : 750" 다음 줄에 thread마다 hit 비율과 마지막 범위, 기다리는 시간
+void print_elimination(ostream &os, const EliminationPolicy *per_thread, int num_thread)
 {
-	atomic<int *> value = EMPTY_VALUE;
-	EliminationSlot *next = nullptr;
-
-	static int *const EMPTY_VALUE;
-
-	~EliminationSlot()
+	EliminationPolicy total;
+	for (auto i = 0; i < num_thread; ++i)
 	{
-		if (value != EMPTY_VALUE && value != nullptr)
-			delete value;
+		total.attempts += per_thread[i].attempts;
+		total.hits += per_thread[i].hits;
+		total.timeouts += per_thread[i].timeouts;
+		total.collisions += per_thread[i].collisions;
 	}
-};
-
-int *const EliminationSlot::EMPTY_VALUE = new int{0};
-
-class EliminationArray
-{
-public:
-	EliminationArray(unsigned num_entry) : num_entry{num_entry}
+	os << "    Elimination : " << total.hit_rate() * 100 << "% hit (" << total.hits << " / " << total.attempts << ")";
+	os << ",  Timeouts : " << total.timeouts << ",  Collisions : " << total.collisions << endl;
+	os << "    Per Thread : ";
+	for (auto i = 0; i < num_thread; ++i)
 	{
-		for (auto i = 0; i < num_entry; ++i)
-			entries.emplace_back(new EliminationSlot);
-		for (auto i = 0; i < num_entry; ++i)
-		{
-			entries[i]->next = entries[(i + 1) % num_entry].get();
-		}
+		if (i != 0)
+			os << ", ";
+		os << '#' << i << ' ' << per_thread[i].hit_rate() * 100 << "% range " << per_thread[i].range << " wait " << per_thread[i].wait;
 	}
+	os << endl;
+}
 
-	bool push(int *value, unsigned idx)
+// EDStack에서 batch가 1보다 크면 연산 하나가 batch개를 push_bulk / pop_bulk 한다. WorkStealingStack은 항상 1
+template <typename Stack>
+void benchMark(Stack &myStack, const vector<int> &cpus, int num_thread, int thread_id, unsigned batch)
+{
+	pin_thread(cpus, thread_id);
+	auto &latency = latencies[thread_id];
+	latency.reset();
+	EliminationPolicy::local().reset_stats();
+	vector<int> values(batch);
+	for (int i = 1; i <= NUM_TEST / num_thread; ++i)
 	{
-		auto my_slot = entries[idx].get();
-		auto next_slot = my_slot->next;
-
-		for (auto try_count = 0; try_count < entries.size()*2; ++try_count)
+		const auto op_begin = LatencyClock::now();
+		if ((fast_rand() % 2) || i <= 1000 / num_thread)
 		{
-			auto my_old_value = my_slot->value.load(memory_order_relaxed);
-			if (my_old_value == nullptr)
-			{
-				if (my_slot->value.compare_exchange_strong(my_old_value, value))
-					return true;
-			}
+			if constexpr (is_same_v<Stack, WorkStealingStack<int>>)
+				myStack.push(i, thread_id);
+			else if (batch == 1)
+				myStack.push(i);
 			else
 			{
-				auto next_old_value = next_slot->value.load(memory_order_relaxed);
-				if (next_old_value == nullptr)
-				{
-					if (next_slot->value.compare_exchange_strong(next_old_value, value))
-						return true;
-					next_slot = next_slot->next;
-				}
+				for (unsigned j = 0; j < batch; ++j)
+					values[j] = i * batch + j;
+				myStack.push_bulk(values.data(), batch);
 			}
+			latency.record(OP_PUSH, op_begin);
 		}
-
-		return false;
-	}
-
-	optional<int> pop(unsigned idx)
-	{
-		auto my_slot = entries[idx].get();
-
-		while (true)
+		else
 		{
-			auto free_ptr = EliminationSlot::EMPTY_VALUE;
-			if (false == my_slot->value.compare_exchange_strong(free_ptr, nullptr))
-				my_slot = my_slot->next;
+			if constexpr (is_same_v<Stack, WorkStealingStack<int>>)
+				myStack.pop(thread_id);
+			else if (batch == 1)
+				myStack.pop();
 			else
-				break;
-		}
-
-		for (volatile auto i = 0; i < POP_WAIT_TIME; ++i)
-			;
-
-		auto val = my_slot->value.load(memory_order_relaxed);
-		if (val != nullptr ||
-			false == my_slot->value.compare_exchange_strong(val, EliminationSlot::EMPTY_VALUE))
-		{
-			auto ret_val = *val;
-			my_slot->value.store(EliminationSlot::EMPTY_VALUE, memory_order_relaxed);
-			delete val;
-			return ret_val;
+				myStack.pop_bulk(values.data(), batch);
+			latency.record(OP_POP, op_begin);
 		}
-
-		return nullopt;
 	}
+	placements[thread_id] = ThreadPlacement::current();
+	eliminations[thread_id] = EliminationPolicy::local();
+}
 
-private:
-	vector<unique_ptr<EliminationSlot>> entries;
-	const unsigned num_entry;
-};
-
-struct Slot
+template <typename Stack>
+chrono::milliseconds run(Stack &myStack, const vector<int> &cpus, int num_thread, unsigned batch)
 {
-	unsigned op;		  // 0 == push, 1 == pop
-	int *value = nullptr; // push일 때 넣을 값, pop일 때 받은 값
-};
-class SlotArray
-{
-public:
-	SlotArray(unsigned entry_num) : entries{entry_num}, el_array{entry_num}
-	{
-		for(auto& entry : entries)
-		{
-			entry.reset(new atomic<Slot*>);
-		}
-	}
-
-	// 일반 thread가 호출할 methods
-	void push(int value, unsigned idx)
-	{
-		int *value_ptr = new int{value};
-
-		Slot *old_entry = nullptr;
-		auto my_slot = new Slot;
-		my_slot->value = value_ptr;
-		my_slot->op = 0;
-
-		auto &entry = entries[idx];
-		while (true)
-		{
-			if (el_array.push(value_ptr, idx))
-				return;
-
-			if (entry->load(memory_order_relaxed) != nullptr)
-				continue;
-			if (false == entry->compare_exchange_strong(old_entry, my_slot))
-				continue;
-
-			while (entry->load(memory_order_relaxed) != nullptr)
-				;
-
-			delete value_ptr;
-			delete my_slot;
-			return;
-		}
-	}
-	optional<int> pop(unsigned idx)
-	{
-		auto my_slot = new Slot;
-		my_slot->op = 1;
-
-		auto &entry = entries[idx];
-		while (true)
-		{
-			auto result = el_array.pop(idx);
-			if (result)
-				return result;
-
-			Slot *old_entry = entry->load(memory_order_relaxed);
-			if (old_entry != nullptr)
-				continue;
-			if (false == entry->compare_exchange_strong(old_entry, my_slot))
-				continue;
-
-			while (entry->load(memory_order_acquire) != nullptr)
-				;
-
-			if (my_slot->value == nullptr)
-				return nullopt;
-
-			auto ret_val = *my_slot->value;
-			delete my_slot->value;
-			delete my_slot;
-			return ret_val;
-		}
-	}
-
-	// helper thread가 호출할 methods
-	void process_ops(stack<int> &stack)
-	{
-		for (auto &op : entries)
-		{
-			auto slot = op->load(memory_order_acquire);
-			if (slot == nullptr)
-				continue;
-
-			if (slot->op == 0)
-			{
-				stack.push(*slot->value);
-			}
-			else if (stack.empty() == false)
-			{
-				slot->value = new int{stack.top()};
-				stack.pop();
-			}
-			else
-			{
-				slot->value = nullptr;
-			}
-			op->store(nullptr, memory_order_release);
-		}
-	}
-
-private:
-	vector<unique_ptr<atomic<Slot *>>> entries;
-	EliminationArray el_array;
-};
+	vector<thread> worker;
+	auto start_t = chrono::high_resolution_clock::now();
+	for (int i = 0; i < num_thread; ++i)
+		worker.emplace_back(benchMark<Stack>, ref(myStack), cref(cpus), num_thread, i, batch);
+	for (auto &th : worker)
+		th.join();
+	return chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - start_t);
+}
 
-void global_helper_func(shared_ptr<vector<unique_ptr<SlotArray, DeallocNUMA<SlotArray>>>> arr, shared_ptr<stack<int>> stack)
+// "    Locality : 97.5% local, 1.5% same node, 0.5% remote, 0.5% empty (pops)" 다음 줄에 thread마다 자기 deque에서 꺼낸 비율
+void print_locality(ostream &os, const WorkStealingStack<int> &stack, int num_thread)
 {
-	while (true)
-	{
-		for (auto &arr_ptr : *arr)
-		{
-			arr_ptr->process_ops(*stack);
-		}
-	}
+	auto percent = [](uint64_t count, uint64_t total) { return total == 0 ? 0.0 : count * 100.0 / total; };
+	const auto total = stack.total_locality();
+	os << "    Locality : " << percent(total.local, total.pops()) << "% local, " << percent(total.same_node, total.pops()) << "% same node, ";
+	os << percent(total.remote, total.pops()) << "% remote, " << percent(total.empty, total.pops()) << "% empty (" << total.pops() << " pops)" << endl;
+	os << "    Per Thread : ";
+	for (auto i = 0; i < num_thread; ++i)
+	{
+		const auto &locality = stack.locality_of(i);
+		if (i != 0)
+			os << ", ";
+		os << '#' << i << ' ' << percent(locality.local, locality.pops()) << "% local";
+	}
+	os << endl;
 }
 
-// Elimination + Delegation
-class EDStack
+int main(int argc, char *argv[])
 {
-public:
-	EDStack(unsigned cores_per_node, unsigned nodes_num) : cores_per_node{cores_per_node},
-														   per_node_arrays{make_shared<vector<unique_ptr<SlotArray, DeallocNUMA<SlotArray>>>>(nodes_num)},
-														   inner_stack{make_shared<stack<int>>()}
-	{
-		auto idx = 0;
-		for (auto &arr : *per_node_arrays)
-		{
-			arr = unique_ptr<SlotArray, DeallocNUMA<SlotArray>>{NUMA_alloc<SlotArray>(idx++, cores_per_node), DeallocNUMA<SlotArray>{}};
-		}
-		global_helper = thread{global_helper_func, per_node_arrays, inner_stack};
-		global_helper.detach();
-	}
-
-	void push(int value)
-	{
-		get_local_array()->push(value, tid % cores_per_node);
-	}
-	optional<int> pop()
+	if (argc < 2)
 	{
-		return get_local_array()->pop(tid % cores_per_node);
+		fprintf(stderr, "you have to give a thread num [, a pin policy: none|compact|scatter|smt (default compact)"
+						", a mode: node|global|ws (default node) and a batch size (default 1)]\n");
+		exit(-1);
 	}
-	void dump(unsigned num)
+	unsigned num_thread = atoi(argv[1]);
+	if (MAX_THREAD < num_thread)
 	{
-		for (auto i = 0; i < num; ++i)
-		{
-			if (inner_stack->empty())
-				break;
-			fprintf(stderr, "%d, ", inner_stack->top());
-			inner_stack->pop();
-		}
-		fprintf(stderr, "\n");
+		fprintf(stderr, "the upper limit of a number of thread is %d\n", MAX_THREAD);
+		exit(-1);
 	}
 
-private:
-	const unsigned cores_per_node;
-	shared_ptr<vector<unique_ptr<SlotArray, DeallocNUMA<SlotArray>>>> per_node_arrays;
-	thread global_helper;
-	shared_ptr<stack<int>> inner_stack;
-
-	SlotArray *get_local_array()
+	auto pin = PinPolicy::Compact;
+	if (argc >= 3 && !parse_pin_policy(argv[2], pin))
 	{
-		static thread_local SlotArray *local_array = (*per_node_arrays)[get_node_id(tid)].get();
-		return local_array;
+		fprintf(stderr, "unknown pin policy: %s\n", argv[2]);
+		exit(-1);
 	}
-};
+	const auto cpus = CpuTopology::get().order(pin);
 
-// Lock-Free Elimination BackOff Stack
-
-void benchMark(EDStack &myStack, int num_thread)
-{
-	if (-1 == numa_run_on_node(get_node_id(tid)))
+	// node와 global은 EDStack의 delegation 방식, ws는 thread마다 work-stealing deque를 두는 WorkStealingStack
+	const string mode = argc >= 4 ? argv[3] : "node";
+	if (mode != "node" && mode != "global" && mode != "ws")
 	{
-		fprintf(stderr, "Can't pin thread #%d to NUMA node #%d\n", tid, get_node_id(tid));
-		return;
-	}
-	for (int i = 1; i <= NUM_TEST / num_thread; ++i)
-	{
-		if ((fast_rand() % 2) || i <= 1000 / num_thread)
-		{
-			myStack.push(i);
-		}
-		else
-		{
-			myStack.pop();
-		}
+		fprintf(stderr, "unknown mode: %s\n", argv[3]);
+		exit(-1);
 	}
-}
 
-int main(int argc, char *argv[])
-{
-	if (argc < 2)
+	const unsigned batch = argc >= 5 ? atoi(argv[4]) : 1;
+	if (batch < 1 || (mode == "ws" && batch != 1))
 	{
-		fprintf(stderr, "you have to give a thread num\n");
+		fprintf(stderr, "batch size must be positive (and 1 with ws): %s\n", argv[4]);
 		exit(-1);
 	}
-	unsigned num_thread = atoi(argv[1]);
-	if (MAX_THREAD < num_thread)
+
+	if (mode == "ws")
 	{
-		fprintf(stderr, "the upper limit of a number of thread is %d\n", MAX_THREAD);
-		exit(-1);
+		WorkStealingStack<int> myStack{num_thread};
+		const auto du = run(myStack, cpus, num_thread, batch);
+
+		CpuTopology::get().describe(cout);
+		cout << num_thread << " Threads,  Pin = " << to_string(pin) << ",  Mode = " << mode << ",  Time = " << du.count() << " ms" << endl;
+		print_latency(cout, latencies, num_thread, STACK_OP_NAMES);
+		print_locality(cout, myStack, num_thread);
+		print_placement(cout, placements, placements + num_thread);
+		return 0;
 	}
 
-	auto core_per_node = (CPU_NUM / 2) / NODE_NUM;
-	EDStack myStack{max(CPU_NUM, num_thread) / NODE_NUM, min(max(num_thread / core_per_node, 1u), NODE_NUM)};
+	const auto delegation = mode == "global" ? Delegation::Global : Delegation::PerNode;
 
-	vector<thread> worker;
-	auto start_t = chrono::high_resolution_clock::now();
-	for (int i = 0; i < num_thread; ++i)
-		worker.emplace_back(benchMark, ref(myStack), num_thread);
-	for (auto &th : worker)
-		th.join();
-	auto du = chrono::high_resolution_clock::now() - start_t;
+	EDStack<int> myStack{EDStack<int>::slots_per_node(num_thread), EDStack<int>::nodes_for(cpus, num_thread), delegation};
+
+	const auto du = run(myStack, cpus, num_thread, batch);
 
 	myStack.dump(10);
 
-	cout << num_thread << " Threads,  Time = ";
-	cout << chrono::duration_cast<chrono::milliseconds>(du).count() << " ms" << endl;
+	CpuTopology::get().describe(cout);
+	cout << num_thread << " Threads,  Pin = " << to_string(pin) << ",  Mode = " << mode << ",  Batch = " << batch << ",  Time = ";
+	cout << du.count() << " ms" << endl;
+	cout << "    Migrations : " << myStack.migrations() << " (" << myStack.migrated_values() << " values)" << endl;
+	print_latency(cout, latencies, num_thread, STACK_OP_NAMES);
+	print_elimination(cout, eliminations, num_thread);
+	print_placement(cout, placements, placements + num_thread);
 }
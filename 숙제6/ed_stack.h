@@ -0,0 +1,724 @@
+#ifndef D3B8F2A6_5C19_4E7D_9B04_A1E6C73F8D52
+#define D3B8F2A6_5C19_4E7D_9B04_A1E6C73F8D52
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <immintrin.h>
+#include <numa.h>
+#include "numa_util.h"
+#include "topology.h"
+
+// Elimination + Delegation stack. NUMA node마다 SlotArray를 두고, elimination에 실패한 연산은 helper thread(combiner)가 모아서 처리한다.
+// 기본은 node마다 combiner를 하나씩 두는 계층형이고, 예전처럼 combiner 하나가 모든 node를 처리하게 할 수도 있다.
+// 벤치마크 main과 분리해서 다른 측정 프로그램에서도 include 할 수 있게 둠.
+
+constexpr unsigned MAX_THREAD = 64;
+
+static std::atomic_uint tid_counter{0};
+static thread_local unsigned tid = tid_counter.fetch_add(1, std::memory_order_relaxed);
+
+// slot의 상태는 64 bit word 하나에 개수와 같이 담는다. 상위 32 bit는 상태, 하위 32 bit는 원소 수.
+// 값 자체는 연산을 맡긴 thread의 buffer에서 바로 복사하므로 push/pop이 값을 주고받을 때 할당이 필요 없음
+enum SlotState : uint32_t
+{
+	// EliminationSlot의 상태
+	EL_EMPTY,
+	EL_CLAIMED, // pop이 자리를 잡는 중이거나 push가 값을 복사하는 중
+	EL_WAITING, // pop이 원소 수만큼 받으려고 기다리는 중
+	EL_FULL,	// push가 원소 수만큼 넘겨줌
+	// Slot(맡긴 연산)의 상태
+	REQ_PUSH,
+	REQ_POP,
+	DONE, // 처리한 원소 수. pop이면 stack이 비어서 요청보다 적을 수 있음
+};
+
+constexpr uint64_t make_word(SlotState state, uint32_t count = 0)
+{
+	return static_cast<uint64_t>(state) << 32 | count;
+}
+constexpr SlotState state_of(uint64_t word)
+{
+	return static_cast<SlotState>(word >> 32);
+}
+constexpr uint32_t count_of(uint64_t word)
+{
+	return static_cast<uint32_t>(word);
+}
+
+// 다른 thread가 word의 상태를 state에서 바꿔줄 때까지 기다리고 바뀐 word를 돌려줌.
+// 잠깐은 pause로 돌고 그 뒤로는 yield해서, thread가 CPU보다 많아도 기다리는 상대(combiner나 복사 중인 push)가 돌 수 있게 함
+constexpr unsigned WAIT_SPIN_COUNT = 64;
+inline uint64_t wait_while(const std::atomic<uint64_t> &word, SlotState state)
+{
+	uint64_t value;
+	for (unsigned spin = 0; state_of(value = word.load(std::memory_order_acquire)) == state; ++spin)
+	{
+		if (spin < WAIT_SPIN_COUNT)
+			_mm_pause();
+		else
+			std::this_thread::yield();
+	}
+	return value;
+}
+
+// elimination에서 thread마다 따로 조정하는 범위와 기다리는 시간, 그리고 그 결과를 센 통계.
+// Hendler, Shavit, Yerushalmi의 adaptive elimination처럼 다른 thread와 slot을 두고 부딪히면 범위를 넓히고 상대를 못 만나면 좁힌다.
+// pop이 기다리는 시간은 만나면 늘리고 못 만나면 줄여서, elimination이 안 되는 동안은 빨리 delegation으로 넘어가게 함.
+struct EliminationPolicy
+{
+	// pop이 상대를 기다리는 시간 (빈 loop 횟수)
+	static constexpr unsigned INITIAL_WAIT = 100;
+	static constexpr unsigned MIN_WAIT = 16;
+	static constexpr unsigned MAX_WAIT = 1600;
+
+	// 자기 slot부터 몇 개의 slot을 볼지
+	unsigned range = 1;
+	unsigned wait = INITIAL_WAIT;
+
+	uint64_t attempts = 0;
+	uint64_t hits = 0;
+	// pop이 기다렸지만, 혹은 push가 범위 안에서 기다리는 pop을 찾지 못함
+	uint64_t timeouts = 0;
+	// 다른 thread가 먼저 slot을 차지함
+	uint64_t collisions = 0;
+
+	static EliminationPolicy &local()
+	{
+		static thread_local EliminationPolicy policy;
+		return policy;
+	}
+
+	// 범위와 기다리는 시간은 그대로 두고 통계만 지움
+	void reset_stats()
+	{
+		attempts = hits = timeouts = collisions = 0;
+	}
+	double hit_rate() const
+	{
+		return attempts == 0 ? 0.0 : static_cast<double>(hits) / attempts;
+	}
+
+	void on_hit()
+	{
+		++hits;
+		wait = std::min(wait * 2, MAX_WAIT);
+	}
+	void on_collision(unsigned max_range)
+	{
+		++collisions;
+		if (range < max_range)
+			++range;
+	}
+	void on_timeout(bool waited)
+	{
+		++timeouts;
+		if (range > 1)
+			--range;
+		if (waited)
+			wait = std::max(wait / 2, MIN_WAIT);
+	}
+};
+
+template <typename T>
+struct alignas(64) EliminationSlot
+{
+	std::atomic<uint64_t> word{make_word(EL_EMPTY)};
+	// 기다리는 pop이 값을 받을 자리
+	T *out = nullptr;
+};
+
+// bulk 연산끼리는 일부만 맞춰도 된다. push는 위쪽(배열의 끝)부터 pop이 원하는 만큼 넘기고 남은 것만 다음 단계로 가져감
+template <typename T>
+class EliminationArray
+{
+public:
+	EliminationArray(unsigned num_entry) : entries(num_entry), num_entry{num_entry} {}
+
+	// idx부터 thread의 범위만큼의 slot에서 기다리는 pop을 찾아 values의 위쪽을 넘김. 넘기고 남은 개수를 돌려줌
+	size_t push(const T *values, size_t count, unsigned idx)
+	{
+		auto &policy = EliminationPolicy::local();
+		const auto range = std::min(policy.range, num_entry);
+		auto collided = false;
+		++policy.attempts;
+
+		for (unsigned i = 0; i < range; ++i)
+		{
+			auto &slot = entries[(idx + i) % num_entry];
+			auto old_word = slot.word.load(std::memory_order_relaxed);
+			if (state_of(old_word) != EL_WAITING)
+				continue;
+			if (false == slot.word.compare_exchange_strong(old_word, make_word(EL_CLAIMED), std::memory_order_acquire))
+			{
+				collided = true;
+				continue;
+			}
+			// 위쪽부터 꺼낸 순서로 복사
+			const auto given = std::min<size_t>(count, count_of(old_word));
+			std::reverse_copy(values + count - given, values + count, slot.out);
+			slot.word.store(make_word(EL_FULL, given), std::memory_order_release);
+			policy.on_hit();
+			return count - given;
+		}
+
+		if (collided)
+			policy.on_collision(num_entry);
+		else
+			policy.on_timeout(false);
+		return count;
+	}
+
+	// 범위 안의 빈 slot 하나를 차지하고 thread의 wait만큼 push를 기다림. 받은 개수를 돌려주고, 빈 slot이 없으면 바로 0
+	size_t pop(T *out, size_t count, unsigned idx)
+	{
+		auto &policy = EliminationPolicy::local();
+		const auto range = std::min(policy.range, num_entry);
+		EliminationSlot<T> *my_slot = nullptr;
+		++policy.attempts;
+
+		for (unsigned i = 0; i < range && my_slot == nullptr; ++i)
+		{
+			auto &slot = entries[(idx + i) % num_entry];
+			auto empty = make_word(EL_EMPTY);
+			if (slot.word.compare_exchange_strong(empty, make_word(EL_CLAIMED)))
+				my_slot = &slot;
+		}
+		if (my_slot == nullptr)
+		{
+			policy.on_collision(num_entry);
+			return 0;
+		}
+		my_slot->out = out;
+		my_slot->word.store(make_word(EL_WAITING, static_cast<uint32_t>(std::min<size_t>(count, UINT32_MAX))), std::memory_order_release);
+
+		for (volatile unsigned i = 0; i < policy.wait; ++i)
+			;
+
+		auto word = my_slot->word.load(std::memory_order_acquire);
+		if (state_of(word) == EL_WAITING && my_slot->word.compare_exchange_strong(word, make_word(EL_EMPTY)))
+		{
+			policy.on_timeout(true);
+			return 0;
+		}
+		// push가 자리를 잡았으면 복사를 끝낼 때까지 기다림
+		word = wait_while(my_slot->word, EL_CLAIMED);
+		my_slot->word.store(make_word(EL_EMPTY), std::memory_order_relaxed);
+		policy.on_hit();
+		return count_of(word);
+	}
+
+private:
+	std::vector<EliminationSlot<T>> entries;
+	const unsigned num_entry;
+};
+
+// combiner가 할 일이 없을 때 잠드는 곳. 연산을 맡긴 thread가 깨운다.
+// combiner는 parked를 세운 뒤 slot을 한 번 더 보고, 맡기는 쪽은 slot에 CAS한 뒤 parked를 보므로 (둘 다 seq_cst) 깨우는 것을 놓치지 않음
+class IdleParker
+{
+public:
+	// 깨우지 않아도 timeout마다 일어나서 멈추라는 요청이 있는지 확인
+	static constexpr auto PARK_TIMEOUT = std::chrono::milliseconds{1};
+
+	template <typename HasWork>
+	void park(HasWork has_work)
+	{
+		parked.store(true);
+		if (has_work())
+		{
+			parked.store(false, std::memory_order_relaxed);
+			return;
+		}
+		std::unique_lock<std::mutex> lg{lock};
+		cv.wait_for(lg, PARK_TIMEOUT, [this] { return parked.load(std::memory_order_relaxed) == false; });
+		parked.store(false, std::memory_order_relaxed);
+	}
+
+	void wake()
+	{
+		if (parked.load() == false)
+			return;
+		{
+			std::lock_guard<std::mutex> lg{lock};
+			parked.store(false, std::memory_order_relaxed);
+		}
+		cv.notify_one();
+	}
+
+private:
+	std::atomic_bool parked{false};
+	std::mutex lock;
+	std::condition_variable cv;
+};
+
+// thread마다 하나씩 가지고 있는 연산 기록. 맡길 연산을 적어 SlotArray의 entry에 걸어두면 combiner가 결과를 같은 word에 돌려준다.
+// 맡긴 thread는 자기 기록만 보며 기다리므로 다른 thread와 cache line을 공유하지 않음
+template <typename T>
+struct alignas(64) Slot
+{
+	std::atomic<uint64_t> word{make_word(DONE)};
+	// push면 넣을 값들, pop이면 받을 자리. 맡긴 thread가 결과를 볼 때까지 그대로 있음
+	T *values = nullptr;
+
+	static Slot &local()
+	{
+		static thread_local Slot slot;
+		return slot;
+	}
+};
+template <typename T>
+class SlotArray
+{
+public:
+	SlotArray(unsigned entry_num) : entries{entry_num}, el_array{entry_num}
+	{
+		for(auto& entry : entries)
+		{
+			entry.reset(new std::atomic<Slot<T> *>{nullptr});
+		}
+	}
+
+	// 일반 thread가 호출할 methods
+	// values[count - 1]이 맨 위에 오도록 넣음. 한 번에 넣을 수 있는 개수는 2^32 미만
+	void push(const T *values, size_t count, unsigned idx)
+	{
+		auto &my_slot = Slot<T>::local();
+		auto &entry = entries[idx];
+		while (true)
+		{
+			count = el_array.push(values, count, idx);
+			if (count == 0)
+				return;
+
+			Slot<T> *old_entry = entry->load(std::memory_order_relaxed);
+			if (old_entry != nullptr)
+				continue;
+			my_slot.values = const_cast<T *>(values);
+			my_slot.word.store(make_word(REQ_PUSH, static_cast<uint32_t>(count)), std::memory_order_relaxed);
+			if (false == entry->compare_exchange_strong(old_entry, &my_slot))
+				continue;
+			parker->wake();
+
+			wait_while(my_slot.word, REQ_PUSH);
+			return;
+		}
+	}
+	// 맨 위부터 count개까지 꺼내서 out에 순서대로 담고 꺼낸 개수를 돌려줌. count보다 적으면 그때 stack이 비어 있었음
+	size_t pop(T *out, size_t count, unsigned idx)
+	{
+		auto &my_slot = Slot<T>::local();
+		auto &entry = entries[idx];
+		size_t popped = 0;
+		while (true)
+		{
+			popped += el_array.pop(out + popped, count - popped, idx);
+			if (popped == count)
+				return popped;
+
+			Slot<T> *old_entry = entry->load(std::memory_order_relaxed);
+			if (old_entry != nullptr)
+				continue;
+			my_slot.values = out + popped;
+			my_slot.word.store(make_word(REQ_POP, static_cast<uint32_t>(count - popped)), std::memory_order_relaxed);
+			if (false == entry->compare_exchange_strong(old_entry, &my_slot))
+				continue;
+			parker->wake();
+
+			return popped + count_of(wait_while(my_slot.word, REQ_POP));
+		}
+	}
+
+	// combiner가 호출할 methods
+	// 맡겨진 연산을 segment(push(const T *, size_t), pop(T *, size_t) -> size_t)에 적용. 처리한 연산이 하나라도 있으면 true
+	// entry를 먼저 비운 뒤 결과를 기록하므로, 결과를 본 thread는 바로 다음 연산을 맡길 수 있고 combiner는 그 뒤로 기록을 건드리지 않음
+	template <typename Segment>
+	bool process_ops(Segment &segment)
+	{
+		auto processed = false;
+		for (auto &op : entries)
+		{
+			auto slot = op->load(std::memory_order_acquire);
+			if (slot == nullptr)
+				continue;
+
+			const auto word = slot->word.load(std::memory_order_relaxed);
+			auto count = count_of(word);
+			if (state_of(word) == REQ_PUSH)
+				segment.push(slot->values, count);
+			else
+				count = static_cast<uint32_t>(segment.pop(slot->values, count));
+			op->store(nullptr, std::memory_order_relaxed);
+			slot->word.store(make_word(DONE, count), std::memory_order_release);
+			processed = true;
+		}
+		return processed;
+	}
+
+	bool has_pending() const
+	{
+		for (auto &op : entries)
+		{
+			if (op->load() != nullptr)
+				return true;
+		}
+		return false;
+	}
+
+	// 이 array에 연산을 맡긴 thread가 깨울 combiner
+	IdleParker *parker = nullptr;
+
+private:
+	std::vector<std::unique_ptr<std::atomic<Slot<T> *>>> entries;
+	EliminationArray<T> el_array;
+};
+
+// SlotArray 몇 개를 맡아서 처리하는 helper. 자기 stack segment를 가지고 맡은 array의 연산을 한 pass씩 모아서 적용한다.
+// 계층형에서는 node마다 하나씩 그 node의 CPU에서 돌고, segment가 비었을 때만 다른 node의 segment에서 위쪽 일부를 가져온다.
+// segment는 pass 동안 lock으로 보호한다. 다른 combiner의 segment는 먼저 try_lock으로 가져와보고,
+// 그래도 못 가져오면 자기 lock을 놓고 모든 segment lock을 주소 순서로 잡으므로 서로 기다리다 멈추지 않음.
+template <typename T>
+class Combiner
+{
+public:
+	// 한 번에 옮기는 최대 원소 수
+	static constexpr size_t MIGRATE_BATCH = 64;
+	// 빈 pass가 이만큼 이어질 때까지는 pause로 돌고, 그다음 IDLE_YIELD_PASSES까지는 yield, 그 뒤로는 잠든다
+	static constexpr unsigned IDLE_SPIN_PASSES = 64;
+	static constexpr unsigned IDLE_YIELD_PASSES = 256;
+
+	Combiner(std::vector<SlotArray<T> *> arrays, std::vector<int> cpus) : arrays{std::move(arrays)}, cpus{std::move(cpus)}
+	{
+		for (auto arr : this->arrays)
+			arr->parker = &parker;
+	}
+
+	// segment가 비었을 때 가져올 후보. 자기 자신이 들어 있어도 됨
+	void set_peers(std::vector<Combiner *> peers)
+	{
+		this->peers = std::move(peers);
+	}
+
+	void run(const std::atomic_bool &stop)
+	{
+		if (!pin_to_cpus(cpus))
+			fprintf(stderr, "Can't pin a combiner thread\n");
+		unsigned idle_passes = 0;
+		while (stop.load(std::memory_order_relaxed) == false)
+		{
+			auto processed = false;
+			{
+				std::lock_guard<std::mutex> lg{segment_lock};
+				for (auto arr : arrays)
+					processed |= arr->process_ops(*this);
+			}
+			if (processed)
+			{
+				idle_passes = 0;
+				continue;
+			}
+
+			++idle_passes;
+			if (idle_passes < IDLE_SPIN_PASSES)
+				_mm_pause();
+			else if (idle_passes < IDLE_YIELD_PASSES)
+				std::this_thread::yield();
+			else
+				parker.park([this] { return has_pending(); });
+		}
+	}
+
+	void wake()
+	{
+		parker.wake();
+	}
+
+	// process_ops가 segment_lock을 잡은 채로 부름. 여러 개를 맡긴 연산도 segment 끝에서 한 번에 복사함
+	void push(const T *values, size_t count)
+	{
+		segment.insert(segment.end(), values, values + count);
+	}
+	size_t pop(T *out, size_t count)
+	{
+		size_t popped = 0;
+		while (popped < count)
+		{
+			if (segment.empty() && !migrate_in())
+				break;
+			const auto taken = std::min(count - popped, segment.size());
+			std::reverse_copy(segment.end() - taken, segment.end(), out + popped);
+			segment.resize(segment.size() - taken);
+			popped += taken;
+		}
+		return popped;
+	}
+
+	// 다른 segment에서 가져온 횟수 / 원소 수
+	uint64_t migrations() const
+	{
+		return migration_count.load(std::memory_order_relaxed);
+	}
+	uint64_t migrated_values() const
+	{
+		return migrated_count.load(std::memory_order_relaxed);
+	}
+
+	// 위에서부터 최대 num개를 꺼내 stderr에 출력하고 꺼낸 수를 돌려줌. T는 ostream으로 출력할 수 있어야 함
+	unsigned dump(unsigned num)
+	{
+		std::lock_guard<std::mutex> lg{segment_lock};
+		unsigned count = 0;
+		for (; count < num && !segment.empty(); ++count)
+		{
+			std::cerr << segment.back() << ", ";
+			segment.pop_back();
+		}
+		return count;
+	}
+
+private:
+	bool has_pending() const
+	{
+		for (auto arr : arrays)
+		{
+			if (arr->has_pending())
+				return true;
+		}
+		return false;
+	}
+
+	// 다른 combiner의 segment 위쪽에서 MIGRATE_BATCH개까지 순서를 유지한 채 가져옴. segment_lock을 가진 채로 부름.
+	// 바로 잡히는 segment에서 못 가져오면 모든 segment를 동시에 잡고 다시 보므로, false면 그 순간 모든 segment가 비어 있었음
+	bool migrate_in()
+	{
+		for (auto peer : peers)
+		{
+			if (peer == this)
+				continue;
+			std::unique_lock<std::mutex> lg{peer->segment_lock, std::try_to_lock};
+			if (lg.owns_lock() && take_from(*peer))
+				return true;
+		}
+
+		// 다른 combiner도 같은 순서로 잡으므로 lock 순서가 엇갈리지 않음.
+		// 자기 lock을 놓은 동안 자기 segment에는 넣는 thread가 없고 비어 있으므로 가져갈 것도 없음
+		auto order = peers;
+		order.push_back(this);
+		std::sort(order.begin(), order.end());
+		order.erase(std::unique(order.begin(), order.end()), order.end());
+		if (order.size() == 1)
+			return false;
+		segment_lock.unlock();
+		std::vector<std::unique_lock<std::mutex>> held;
+		for (auto combiner : order)
+		{
+			if (combiner == this)
+				segment_lock.lock();
+			else
+				held.emplace_back(combiner->segment_lock);
+		}
+		for (auto peer : peers)
+		{
+			if (peer != this && take_from(*peer))
+				return true;
+		}
+		return false;
+	}
+
+	// 두 segment의 lock을 모두 가진 상태에서 부름
+	bool take_from(Combiner &peer)
+	{
+		auto &from = peer.segment;
+		if (from.empty())
+			return false;
+		const auto count = std::min(MIGRATE_BATCH, from.size());
+		segment.insert(segment.end(), from.end() - count, from.end());
+		from.resize(from.size() - count);
+		migration_count.fetch_add(1, std::memory_order_relaxed);
+		migrated_count.fetch_add(count, std::memory_order_relaxed);
+		return true;
+	}
+
+	const std::vector<SlotArray<T> *> arrays;
+	// 비어 있으면 고정하지 않음
+	const std::vector<int> cpus;
+	std::vector<Combiner *> peers;
+	std::mutex segment_lock;
+	// 위쪽이 back. combiner thread가 처음 채우므로 고정된 node의 메모리에 잡힘
+	std::vector<T> segment;
+	IdleParker parker;
+	std::atomic<uint64_t> migration_count{0};
+	std::atomic<uint64_t> migrated_count{0};
+};
+
+enum class Delegation
+{
+	// 예전 방식. combiner 하나가 모든 node의 array를 처리
+	Global,
+	// node마다 combiner를 두고 segment가 비면 다른 node에서 가져옴
+	PerNode,
+};
+
+inline const char *to_string(Delegation delegation)
+{
+	return delegation == Delegation::Global ? "global" : "node";
+}
+
+// Elimination + Delegation. T는 task handle처럼 복사만으로 옮길 수 있는 값이어야 한다
+template <typename T>
+class EDStack
+{
+	static_assert(std::is_trivially_copyable_v<T>, "values are copied between threads without running constructors");
+
+public:
+	// 생성자 인자를 고르는 방법. slot은 node마다 그 node의 CPU 수(thread가 더 많으면 thread 수를 node 수로 나눈 값)만큼,
+	// node 수는 cpus 순서로 고정된 num_thread개의 thread가 실제로 걸치는 node 수
+	static unsigned slots_per_node(unsigned num_thread)
+	{
+		const auto &topology = CpuTopology::get();
+		return std::max<unsigned>(std::max<unsigned>(topology.cpus().size(), num_thread) / topology.num_nodes(), 1u);
+	}
+	static unsigned nodes_for(const std::vector<int> &cpus, unsigned num_thread)
+	{
+		return CpuTopology::get().nodes_spanned(cpus, num_thread);
+	}
+
+	EDStack(unsigned cores_per_node, unsigned nodes_num, Delegation delegation = Delegation::PerNode)
+		: instance_id{instance_counter.fetch_add(1, std::memory_order_relaxed) + 1},
+		  cores_per_node{cores_per_node},
+		  per_node_arrays(nodes_num)
+	{
+		auto idx = 0;
+		for (auto &arr : per_node_arrays)
+		{
+			arr = std::unique_ptr<SlotArray<T>, DeallocNUMA<SlotArray<T>>>{NUMA_alloc<SlotArray<T>>(idx++, cores_per_node), DeallocNUMA<SlotArray<T>>{}};
+		}
+
+		if (delegation == Delegation::Global)
+		{
+			std::vector<SlotArray<T> *> arrays;
+			for (auto &arr : per_node_arrays)
+				arrays.push_back(arr.get());
+			combiners.emplace_back(NUMA_alloc<Combiner<T>>(0, std::move(arrays), std::vector<int>{}), DeallocNUMA<Combiner<T>>{});
+		}
+		else
+		{
+			// array i는 get_local_array에서 node % nodes_num == i인 node의 thread들이 쓰므로 combiner도 그 CPU들에 둔다
+			for (unsigned i = 0; i < nodes_num; ++i)
+			{
+				std::vector<int> cpus;
+				for (auto &info : CpuTopology::get().cpus())
+				{
+					if (info.node % nodes_num == i)
+						cpus.push_back(info.cpu);
+				}
+				combiners.emplace_back(NUMA_alloc<Combiner<T>>(i, std::vector<SlotArray<T> *>{per_node_arrays[i].get()}, std::move(cpus)), DeallocNUMA<Combiner<T>>{});
+			}
+		}
+
+		std::vector<Combiner<T> *> peers;
+		for (auto &combiner : combiners)
+			peers.push_back(combiner.get());
+		// 가까운 node부터 보도록 자기 다음 번호부터 돌아가며 나열
+		for (size_t i = 0; i < combiners.size(); ++i)
+		{
+			std::rotate(peers.begin(), peers.begin() + 1, peers.end());
+			combiners[i]->set_peers(peers);
+		}
+		for (auto &combiner : combiners)
+			helpers.emplace_back(&Combiner<T>::run, combiner.get(), std::cref(stop_helper));
+	}
+	// 한 process에서 여러 번 만들 수 있도록 helper thread를 멈추고 기다린다.
+	~EDStack()
+	{
+		stop_helper.store(true, std::memory_order_relaxed);
+		for (auto &combiner : combiners)
+			combiner->wake();
+		for (auto &helper : helpers)
+			helper.join();
+	}
+
+	void push(T value)
+	{
+		get_local_array()->push(&value, 1, tid % cores_per_node);
+	}
+	std::optional<T> pop()
+	{
+		T value;
+		if (get_local_array()->pop(&value, 1, tid % cores_per_node) == 0)
+			return std::nullopt;
+		return value;
+	}
+	// values[0]부터 차례로 push한 것과 같음. 일부는 elimination으로 다른 pop에 넘어가고 나머지는 한 번에 delegation
+	void push_bulk(const T *values, size_t count)
+	{
+		if (count > 0)
+			get_local_array()->push(values, count, tid % cores_per_node);
+	}
+	// pop을 count번 한 것과 같은 순서로 out에 담고 꺼낸 개수를 돌려줌. count보다 적으면 stack이 비어 있었음
+	size_t pop_bulk(T *out, size_t count)
+	{
+		if (count == 0)
+			return 0;
+		return get_local_array()->pop(out, count, tid % cores_per_node);
+	}
+	void dump(unsigned num)
+	{
+		for (auto &combiner : combiners)
+			num -= combiner->dump(num);
+		std::cerr << std::endl;
+	}
+
+	uint64_t migrations() const
+	{
+		uint64_t sum = 0;
+		for (auto &combiner : combiners)
+			sum += combiner->migrations();
+		return sum;
+	}
+	uint64_t migrated_values() const
+	{
+		uint64_t sum = 0;
+		for (auto &combiner : combiners)
+			sum += combiner->migrated_values();
+		return sum;
+	}
+
+private:
+	static inline std::atomic_uint instance_counter{0};
+	const unsigned instance_id;
+	const unsigned cores_per_node;
+	std::vector<std::unique_ptr<SlotArray<T>, DeallocNUMA<SlotArray<T>>>> per_node_arrays;
+	std::vector<std::unique_ptr<Combiner<T>, DeallocNUMA<Combiner<T>>>> combiners;
+	std::vector<std::thread> helpers;
+	std::atomic_bool stop_helper{false};
+
+	// thread마다 마지막으로 사용한 stack과 그 array를 기억. 다른 EDStack을 쓰면 다시 찾음
+	// (해제된 stack과 주소가 같을 수 있으므로 주소 대신 instance_id로 구분)
+	// array는 처음 호출했을 때 thread가 있던 CPU의 node로 고름. thread를 먼저 고정해두어야 node가 바뀌지 않음
+	SlotArray<T> *get_local_array()
+	{
+		static thread_local unsigned owner_id = 0;
+		static thread_local SlotArray<T> *local_array = nullptr;
+		if (owner_id != instance_id)
+		{
+			owner_id = instance_id;
+			const auto cpu = sched_getcpu();
+			const auto node = cpu < 0 ? 0 : CpuTopology::get().node_of(cpu);
+			local_array = per_node_arrays[node % per_node_arrays.size()].get();
+		}
+		return local_array;
+	}
+};
+
+#endif /* D3B8F2A6_5C19_4E7D_9B04_A1E6C73F8D52 */
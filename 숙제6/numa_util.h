@@ -1,6 +1,8 @@
 #ifndef C2A0BB25_4014_4864_ABBB_67EF5B019AB0
 #define C2A0BB25_4014_4864_ABBB_67EF5B019AB0
 
+#include <cstddef>
+#include <new>
 #include <utility>
 #include <numa.h>
 
@@ -27,6 +29,24 @@ void NUMA_dealloc(T *ptr)
     numa_free(ptr, sizeof(T));
 }
 
+// count개를 numa_id node에 연속으로 만든다. NUMA_dealloc_array로 같은 count를 주고 해제
+template <typename T>
+T *NUMA_alloc_array(unsigned numa_id, size_t count)
+{
+    T *ptr = static_cast<T *>(numa_alloc_onnode(sizeof(T) * count, numa_id));
+    for (size_t i = 0; i < count; ++i)
+        new (ptr + i) T();
+    return ptr;
+}
+
+template <typename T>
+void NUMA_dealloc_array(T *ptr, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        ptr[i].~T();
+    numa_free(ptr, sizeof(T) * count);
+}
+
 template <typename T>
 struct DeallocNUMA
 {
@@ -0,0 +1,264 @@
+#ifndef A8E3C1D4_7B52_4F69_9D20_C4F1B86E3A57
+#define A8E3C1D4_7B52_4F69_9D20_C4F1B86E3A57
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include <sched.h>
+#include "numa_util.h"
+#include "topology.h"
+
+// thread마다 Chase–Lev work-stealing deque를 하나씩 두고 stack처럼 쓰는 구현. EDStack과 같은 벤치마크로 비교하기 위해 둠.
+// 자기가 넣은 것을 자기가 꺼내는 동안은 다른 thread와 공유하는 쓰기가 없고, 자기 deque가 비었을 때만 다른 thread의 deque에서 가장 오래된 것을 훔친다.
+// 그래서 LIFO는 thread마다 자기 deque 안에서만 지켜짐.
+
+// Lê, Pop, Cohen, Zappa Nardelli의 "Correct and Efficient Work-Stealing for Weak Memory Models"에 있는 C11 버전을 따른다.
+// 크기가 2의 거듭제곱인 원형 array를 쓰고, 가득 차면 owner가 두 배로 키운다.
+template <typename T>
+class ChaseLevDeque
+{
+	// owner만 만들고 바꾼다. 바뀐 뒤에도 steal 중인 thread가 예전 array를 읽을 수 있으므로 deque가 없어질 때 한꺼번에 해제
+	struct Ring
+	{
+		const size_t capacity;
+		std::atomic<T> *const items;
+
+		Ring(unsigned node, size_t capacity) : capacity{capacity}, items{NUMA_alloc_array<std::atomic<T>>(node, capacity)} {}
+		~Ring()
+		{
+			NUMA_dealloc_array(items, capacity);
+		}
+		T get(int64_t i) const
+		{
+			return items[i & (capacity - 1)].load(std::memory_order_relaxed);
+		}
+		void put(int64_t i, T value)
+		{
+			items[i & (capacity - 1)].store(value, std::memory_order_relaxed);
+		}
+	};
+
+public:
+	static constexpr size_t INITIAL_CAPACITY = 1024;
+
+	enum class StealResult
+	{
+		Success,
+		Empty,
+		// 다른 thread(혹은 owner)와 경쟁해서 짐. 비어 있다는 뜻은 아님
+		Abort,
+	};
+
+	// 원형 array를 node의 메모리에 잡는다
+	explicit ChaseLevDeque(unsigned node) : node{node}
+	{
+		rings.emplace_back(new Ring{node, INITIAL_CAPACITY});
+		ring.store(rings.back().get(), std::memory_order_relaxed);
+	}
+
+	unsigned node_id() const
+	{
+		return node;
+	}
+
+	// owner만 호출. 값을 쓴 뒤 bottom을 release store로 올리는 것이 전부이고, x86에서는 평범한 store
+	void push(T value)
+	{
+		const auto b = bottom.load(std::memory_order_relaxed);
+		const auto t = top.load(std::memory_order_acquire);
+		auto r = ring.load(std::memory_order_relaxed);
+		if (b - t > static_cast<int64_t>(r->capacity) - 1)
+			r = grow(r, t, b);
+		r->put(b, value);
+		bottom.store(b + 1, std::memory_order_release);
+	}
+
+	// owner만 호출. bottom을 내린 뒤 top을 읽는 순서만은 steal과 맞물려야 하므로 논문의 seq_cst fence 대신
+	// bottom을 seq_cst로 쓰고 top을 seq_cst로 읽는다. x86에서는 xchg 하나이고 따로 mfence가 들어가지 않음.
+	// 마지막 하나를 꺼낼 때만 steal과 top을 두고 CAS로 경쟁
+	std::optional<T> pop()
+	{
+		const auto b = bottom.load(std::memory_order_relaxed) - 1;
+		auto r = ring.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_seq_cst);
+		auto t = top.load(std::memory_order_seq_cst);
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+
+		const auto value = r->get(b);
+		if (t == b)
+		{
+			const auto won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			if (!won)
+				return std::nullopt;
+		}
+		return value;
+	}
+
+	// owner가 아닌 thread가 호출. 가장 오래된(top) 것을 가져감
+	StealResult steal(T &out)
+	{
+		auto t = top.load(std::memory_order_seq_cst);
+		const auto b = bottom.load(std::memory_order_seq_cst);
+		if (t >= b)
+			return StealResult::Empty;
+
+		auto r = ring.load(std::memory_order_acquire);
+		const auto value = r->get(t);
+		if (false == top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return StealResult::Abort;
+		out = value;
+		return StealResult::Success;
+	}
+
+private:
+	// [t, b)를 두 배 크기의 array로 옮김
+	Ring *grow(Ring *old, int64_t t, int64_t b)
+	{
+		auto r = new Ring{node, old->capacity * 2};
+		for (auto i = t; i < b; ++i)
+			r->put(i, old->get(i));
+		rings.emplace_back(r);
+		ring.store(r, std::memory_order_release);
+		return r;
+	}
+
+	// owner만 쓰는 bottom과 모두가 CAS하는 top을 다른 cache line에 둠
+	alignas(64) std::atomic<int64_t> top{0};
+	alignas(64) std::atomic<int64_t> bottom{0};
+	std::atomic<Ring *> ring;
+	// owner만 건드림
+	std::vector<std::unique_ptr<Ring>> rings;
+	const unsigned node;
+};
+
+// thread마다 ChaseLevDeque를 하나씩 두는 stack. push는 항상 자기 deque에 하고, pop은 자기 deque가 비었을 때만 훔친다.
+// 훔칠 때는 같은 node의 thread부터 보고 그다음에 다른 node를 본다.
+template <typename T>
+class WorkStealingStack
+{
+	static_assert(std::is_trivially_copyable_v<T>, "values are copied between threads without running constructors");
+
+public:
+	// Abort만 보고 지나간 deque가 있으면 비어 있다고 단정할 수 없으므로 한 바퀴 더 봄
+	static constexpr int MAX_STEAL_ROUNDS = 4;
+
+	// thread 하나가 한 pop의 출처. 그 thread만 쓰므로 측정이 끝난 뒤 읽을 것
+	struct alignas(64) Locality
+	{
+		uint64_t local = 0;
+		uint64_t same_node = 0;
+		uint64_t remote = 0;
+		uint64_t empty = 0;
+
+		uint64_t pops() const
+		{
+			return local + same_node + remote + empty;
+		}
+	};
+
+	explicit WorkStealingStack(unsigned num_thread) : deques(num_thread), localities(num_thread) {}
+	WorkStealingStack(const WorkStealingStack &) = delete;
+	~WorkStealingStack()
+	{
+		for (auto &deque : deques)
+		{
+			if (auto ptr = deque.load(std::memory_order_relaxed))
+				NUMA_dealloc(ptr);
+		}
+	}
+
+	void push(T value, unsigned thread_id)
+	{
+		local_deque(thread_id)->push(value);
+	}
+	std::optional<T> pop(unsigned thread_id)
+	{
+		auto &locality = localities[thread_id];
+		if (auto value = local_deque(thread_id)->pop())
+		{
+			++locality.local;
+			return value;
+		}
+		return steal(thread_id, locality);
+	}
+
+	const Locality &locality_of(unsigned thread_id) const
+	{
+		return localities[thread_id];
+	}
+	Locality total_locality() const
+	{
+		Locality sum;
+		for (auto &locality : localities)
+		{
+			sum.local += locality.local;
+			sum.same_node += locality.same_node;
+			sum.remote += locality.remote;
+			sum.empty += locality.empty;
+		}
+		return sum;
+	}
+
+private:
+	// thread_id의 deque. 처음 부를 때 그 thread가 있는 node에 만드므로 thread를 먼저 고정해두어야 함
+	ChaseLevDeque<T> *local_deque(unsigned thread_id)
+	{
+		auto deque = deques[thread_id].load(std::memory_order_relaxed);
+		if (deque == nullptr)
+		{
+			const auto cpu = sched_getcpu();
+			const unsigned node = cpu < 0 ? 0 : CpuTopology::get().node_of(cpu);
+			deque = NUMA_alloc<ChaseLevDeque<T>>(node, node);
+			deques[thread_id].store(deque, std::memory_order_release);
+		}
+		return deque;
+	}
+
+	std::optional<T> steal(unsigned thread_id, Locality &locality)
+	{
+		const auto my_node = local_deque(thread_id)->node_id();
+		const auto num_deque = deques.size();
+		for (auto round = 0; round < MAX_STEAL_ROUNDS; ++round)
+		{
+			auto aborted = false;
+			for (auto same_node : {true, false})
+			{
+				for (size_t i = 1; i < num_deque; ++i)
+				{
+					auto victim = deques[(thread_id + i) % num_deque].load(std::memory_order_acquire);
+					if (victim == nullptr || (victim->node_id() == my_node) != same_node)
+						continue;
+					T value;
+					switch (victim->steal(value))
+					{
+					case ChaseLevDeque<T>::StealResult::Success:
+						++(same_node ? locality.same_node : locality.remote);
+						return value;
+					case ChaseLevDeque<T>::StealResult::Abort:
+						aborted = true;
+						break;
+					default:
+						break;
+					}
+				}
+			}
+			if (!aborted)
+				break;
+		}
+		++locality.empty;
+		return std::nullopt;
+	}
+
+	std::vector<std::atomic<ChaseLevDeque<T> *>> deques;
+	std::vector<Locality> localities;
+};
+
+#endif /* A8E3C1D4_7B52_4F69_9D20_C4F1B86E3A57 */